@@ -0,0 +1,308 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "metrics/histogram.hpp"
+#include "queue/bounded_queue.hpp"
+#include "queue/lock_free_queue.hpp"
+#include "queue/priority_queue.hpp"
+#include "queue/unbounded_queue.hpp"
+#include "task_dispatcher.hpp"
+#include "types.hpp"
+
+// Пропускная способность и латентность (от постановки задачи до начала ее выполнения) очередей, PriorityQueue и
+// TaskDispatcher. Для отслеживания регрессий результаты пишутся в JSON: цель dispatcher_bench_json или
+//     dispatcher_bench --benchmark_out=result.json --benchmark_out_format=json
+
+using namespace dispatcher;
+using namespace dispatcher::queue;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kTasksPerIteration = size_t {1} << 14;
+
+// Собирает латентности со всех потоков, выполняющих задачи: у каждого потока своя гистограмма с одним писателем.
+class LatencyRecorder {
+    inline static std::atomic<uint64_t> next_id_ {1};
+
+    const uint64_t id_ = next_id_.fetch_add(1, std::memory_order_relaxed);
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<metrics::LatencyHistogram>> histograms_;
+
+    public:
+    void Record(Clock::time_point enqueued) {
+        struct Cache {
+            uint64_t owner                       = 0;
+            metrics::LatencyHistogram* histogram = nullptr;
+        };
+        thread_local Cache cache;
+        if(cache.owner != id_) {
+            std::lock_guard lock(mutex_);
+            cache = {id_, histograms_.emplace_back(std::make_unique<metrics::LatencyHistogram>()).get()};
+        }
+        cache.histogram->Record(static_cast<uint64_t>((Clock::now() - enqueued).count()));
+    }
+
+    void Report(benchmark::State& state) {
+        metrics::HistogramSnapshot snapshot;
+        std::lock_guard lock(mutex_);
+        for(const auto& histogram: histograms_) {
+            histogram->AddTo(snapshot);
+        }
+        state.counters["p50_ns"]  = static_cast<double>(snapshot.Percentile(0.5));
+        state.counters["p99_ns"]  = static_cast<double>(snapshot.Percentile(0.99));
+        state.counters["p999_ns"] = static_cast<double>(snapshot.Percentile(0.999));
+        state.counters["max_ns"]  = static_cast<double>(snapshot.max);
+    }
+};
+
+// Задача с захватом размера Size байт: 16 и 48 помещаются во встроенный буфер Task, 128 - уже нет.
+template<size_t Size>
+Task MakeTask(LatencyRecorder& recorder, std::atomic<size_t>& done) {
+    static_assert(Size >= sizeof(Clock::time_point));
+    std::array<std::byte, Size - sizeof(Clock::time_point)> padding {};
+    return [&recorder, &done, padding, enqueued = Clock::now()] {
+        recorder.Record(enqueued);
+        benchmark::DoNotOptimize(padding);
+        done.fetch_add(1, std::memory_order_relaxed);
+    };
+}
+
+void Finish(benchmark::State& state, LatencyRecorder& recorder) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kTasksPerIteration));
+    recorder.Report(state);
+}
+
+// Отдельная очередь: range(0) производителей, range(1) потребителей, range(2) - емкость (для неограниченной не
+// используется).
+template<typename Queue, size_t TaskSize>
+void BM_Queue(benchmark::State& state) {
+    const auto producers = static_cast<size_t>(state.range(0));
+    const auto consumers = static_cast<size_t>(state.range(1));
+    std::unique_ptr<Queue> queue;
+    if constexpr(std::is_same_v<Queue, UnboundedQueue>) {
+        queue = std::make_unique<Queue>();
+    }
+    else {
+        queue = std::make_unique<Queue>(static_cast<int>(state.range(2)));
+    }
+
+    LatencyRecorder recorder;
+    std::atomic<size_t> done {0};
+    for(auto _: state) {
+        std::vector<std::jthread> threads;
+        for(size_t i = 0; i < consumers; ++i) {
+            threads.emplace_back([&] {
+                for(size_t n = 0; n < kTasksPerIteration / consumers; ++n) {
+                    (*queue->Pop())();
+                }
+            });
+        }
+        for(size_t i = 0; i < producers; ++i) {
+            threads.emplace_back([&] {
+                for(size_t n = 0; n < kTasksPerIteration / producers; ++n) {
+                    queue->Push(MakeTask<TaskSize>(recorder, done));
+                }
+            });
+        }
+    }
+    Finish(state, recorder);
+}
+
+void QueueArgs(benchmark::internal::Benchmark* bench) {
+    bench->ArgNames({"producers", "consumers", "capacity"});
+    for(int64_t producers: {1, 4}) {
+        for(int64_t consumers: {1, 4}) {
+            for(int64_t capacity: {64, 4096}) {
+                bench->Args({producers, consumers, capacity});
+            }
+        }
+    }
+    bench->UseRealTime();
+}
+
+BENCHMARK_TEMPLATE(BM_Queue, BoundedQueue, 48)->Apply(QueueArgs);
+BENCHMARK_TEMPLATE(BM_Queue, LockFreeQueue, 48)->Apply(QueueArgs);
+BENCHMARK_TEMPLATE(BM_Queue, UnboundedQueue, 48)
+    ->ArgNames({"producers", "consumers", "capacity"})
+    ->Args({1, 1, 0})
+    ->Args({4, 4, 0})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Queue, UnboundedQueue, 16)->Args({4, 4, 0})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Queue, UnboundedQueue, 128)->Args({4, 4, 0})->UseRealTime();
+
+// PriorityQueue: range(0) производителей, range(1) потребителей, range(2) - процент задач High, range(3) - емкость
+// ограниченной очереди High, range(4) - число шардов каждого уровня (QueueOptions::shards).
+void BM_PriorityQueue(benchmark::State& state) {
+    const auto producers  = static_cast<size_t>(state.range(0));
+    const auto consumers  = static_cast<size_t>(state.range(1));
+    const auto high_share = static_cast<size_t>(state.range(2));
+    const auto shards     = static_cast<size_t>(state.range(4));
+    QueueOptions high {true, static_cast<int>(state.range(3))};
+    QueueOptions normal {false, std::nullopt};
+    high.shards   = shards;
+    normal.shards = shards;
+    const std::map<TaskPriority, QueueOptions> config = {{TaskPriority::High, high}, {TaskPriority::Normal, normal}};
+    PriorityQueue pq(config);
+
+    LatencyRecorder recorder;
+    std::atomic<size_t> done {0};
+    for(auto _: state) {
+        std::vector<std::jthread> threads;
+        for(size_t i = 0; i < consumers; ++i) {
+            threads.emplace_back([&] {
+                for(size_t n = 0; n < kTasksPerIteration / consumers; ++n) {
+                    (*pq.Pop())();
+                }
+            });
+        }
+        for(size_t i = 0; i < producers; ++i) {
+            threads.emplace_back([&] {
+                for(size_t n = 0; n < kTasksPerIteration / producers; ++n) {
+                    const auto priority = n % 100 < high_share ? TaskPriority::High : TaskPriority::Normal;
+                    pq.Push(priority, MakeTask<48>(recorder, done));
+                }
+            });
+        }
+    }
+    Finish(state, recorder);
+}
+
+BENCHMARK(BM_PriorityQueue)
+    ->ArgNames({"producers", "consumers", "high_pct", "capacity", "shards"})
+    ->ArgsProduct({{1, 4}, {1, 4}, {0, 10, 50}, {64, 4096}, {1, 8}})
+    ->UseRealTime();
+
+// Ложное разделение кэш-линий: range(0) потоков, у каждого свой уровень PriorityQueue, в который он кладет задачу и
+// сразу ее забирает. Общих данных у потоков нет, поэтому все, что мешает пропускной способности расти с числом потоков,
+// - трафик кэш-линий между ядрами: соседние очереди уровней, маска непустых уровней, условная переменная. Трафик виден
+// напрямую в счетчиках процессора:
+//     perf stat -e cache-misses,LLC-load-misses dispatcher_bench --benchmark_filter=BM_IndependentLevels
+// или через --benchmark_perf_counters=CYCLES,INSTRUCTIONS, если Google Benchmark собран с libpfm.
+void BM_IndependentLevels(benchmark::State& state) {
+    const auto threads = static_cast<size_t>(state.range(0));
+    std::map<TaskPriority, QueueOptions> config;
+    for(size_t level = 0; level < threads; ++level) {
+        config.emplace(PriorityLevel(level), QueueOptions {true, 1024});
+    }
+    PriorityQueue pq(config);
+
+    for(auto _: state) {
+        std::vector<std::jthread> workers;
+        for(size_t level = 0; level < threads; ++level) {
+            workers.emplace_back([&pq, level, threads] {
+                const auto priority = PriorityLevel(level);
+                for(size_t n = 0; n < kTasksPerIteration / threads; ++n) {
+                    pq.Push(priority, [] {});
+                    benchmark::DoNotOptimize(pq.TryPop(priority));
+                }
+            });
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kTasksPerIteration));
+}
+
+BENCHMARK(BM_IndependentLevels)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+// TaskDispatcher целиком: range(0) воркеров, range(1) производителей, range(2) - процент задач High, range(3) - размер
+// пачки, которую воркер забирает за раз (ThreadPoolOptions::pop_batch), range(4) - бюджет вращения воркера перед сном
+// (ThreadPoolOptions::spin).
+void BM_Dispatcher(benchmark::State& state) {
+    const auto workers    = static_cast<size_t>(state.range(0));
+    const auto producers  = static_cast<size_t>(state.range(1));
+    const auto high_share = static_cast<size_t>(state.range(2));
+    LatencyRecorder recorder;
+    std::atomic<size_t> done {0};
+    const thread_pool::ThreadPoolOptions options = {
+        .pop_batch = static_cast<size_t>(state.range(3)),
+        .spin      = {static_cast<uint32_t>(state.range(4)), state.range(4) > 0 ? 16u : 0u}};
+    TaskDispatcher td(workers, init_config, options);
+
+    size_t expected = 0;
+    for(auto _: state) {
+        {
+            std::vector<std::jthread> threads;
+            for(size_t i = 0; i < producers; ++i) {
+                threads.emplace_back([&] {
+                    for(size_t n = 0; n < kTasksPerIteration / producers; ++n) {
+                        const auto priority = n % 100 < high_share ? TaskPriority::High : TaskPriority::Normal;
+                        td.Schedule(priority, MakeTask<48>(recorder, done));
+                    }
+                });
+            }
+        }
+        expected += kTasksPerIteration;
+        while(done.load(std::memory_order_relaxed) < expected) {
+            std::this_thread::yield();
+        }
+    }
+    Finish(state, recorder);
+}
+
+BENCHMARK(BM_Dispatcher)
+    ->ArgNames({"workers", "producers", "high_pct", "pop_batch", "spin"})
+    ->ArgsProduct({{1, 4}, {1, 4}, {0, 50}, {1, 16}, {0, 4096}})
+    ->UseRealTime();
+
+// Цикл из range(1) итераций на range(0) воркерах: ParallelFor с ленивым разбиением против ручного разбиения на
+// задачу-итерацию через Schedule() с ожиданием счетчика. Итерация - несколько десятков наносекунд вычислений, поэтому
+// ручной вариант упирается в стоимость постановки задач.
+uint64_t Iteration(uint64_t i) {
+    uint64_t x = i * 0x9E3779B97F4A7C15ull;
+    for(int round = 0; round < 8; ++round) {
+        x ^= x >> 29;
+        x *= 0xBF58476D1CE4E5B9ull;
+    }
+    return x;
+}
+
+void BM_ParallelFor(benchmark::State& state) {
+    const auto workers = static_cast<size_t>(state.range(0));
+    const auto size    = static_cast<size_t>(state.range(1));
+    TaskDispatcher td(workers);
+    std::vector<uint64_t> out(size);
+    for(auto _: state) {
+        td.ParallelFor(std::views::iota(size_t {0}, size), 256, [&out](size_t i) { out[i] = Iteration(i); });
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+void BM_ScheduleLoop(benchmark::State& state) {
+    const auto workers = static_cast<size_t>(state.range(0));
+    const auto size    = static_cast<size_t>(state.range(1));
+    TaskDispatcher td(workers);
+    std::vector<uint64_t> out(size);
+    for(auto _: state) {
+        std::atomic<size_t> done {0};
+        for(size_t i = 0; i < size; ++i) {
+            td.Schedule(TaskPriority::Normal, [&out, &done, i] {
+                out[i] = Iteration(i);
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }
+        while(done.load(std::memory_order_acquire) < size) {
+            std::this_thread::yield();
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+BENCHMARK(BM_ParallelFor)->ArgNames({"workers", "size"})->ArgsProduct({{1, 4}, {1 << 10, 1 << 16}})->UseRealTime();
+BENCHMARK(BM_ScheduleLoop)->ArgNames({"workers", "size"})->ArgsProduct({{1, 4}, {1 << 10, 1 << 16}})->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+#include "queue/priority_queue.hpp"
+#include "task.hpp"
+#include "types.hpp"
+
+// Считаем все выделения памяти в процессе, чтобы показать, сколько аллокаций приходится на одну задачу.
+namespace {
+
+std::atomic<size_t> allocations {0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace dispatcher;
+using namespace dispatcher::queue;
+
+namespace {
+
+// Типичная задача: несколько указателей и чисел в захвате, 48 байт - больше встроенного буфера std::function.
+struct Payload {
+    std::atomic<size_t>* counter;
+    const void* a;
+    const void* b;
+    size_t x;
+    size_t y;
+    size_t z;
+};
+
+auto MakeLambda(Payload p) {
+    return [p] { p.counter->fetch_add(p.x + p.y + p.z, std::memory_order_relaxed); };
+}
+
+void ReportAllocations(benchmark::State& state, size_t before) {
+    state.counters["allocs_per_task"] = benchmark::Counter(static_cast<double>(allocations.load() - before),
+                                                           benchmark::Counter::kAvgIterations);
+}
+
+template<typename Callable>
+void BM_ConstructMoveInvoke(benchmark::State& state) {
+    std::atomic<size_t> counter {0};
+    Payload payload {&counter, &state, &counter, 1, 2, 3};
+
+    const auto before = allocations.load();
+    for(auto _: state) {
+        Callable task  = MakeLambda(payload);
+        Callable moved = std::move(task);
+        moved();
+    }
+    ReportAllocations(state, before);
+}
+
+BENCHMARK_TEMPLATE(BM_ConstructMoveInvoke, std::function<void()>);
+BENCHMARK_TEMPLATE(BM_ConstructMoveInvoke, Task);
+
+// Полный путь задачи через PriorityQueue в установившемся режиме: очередь прогрета до начала измерения.
+void BM_PriorityQueueRoundTrip(benchmark::State& state) {
+    const bool lock_free = state.range(0) != 0;
+    const std::map<TaskPriority, QueueOptions> config = {
+        {TaskPriority::High, QueueOptions {true, 1024, lock_free}}};
+    PriorityQueue pq(config);
+
+    std::atomic<size_t> counter {0};
+    Payload payload {&counter, &state, &counter, 1, 2, 3};
+
+    for(int i = 0; i < 1024; ++i) {
+        pq.Push(TaskPriority::High, MakeLambda(payload));
+        (*pq.Pop())();
+    }
+
+    const auto before = allocations.load();
+    for(auto _: state) {
+        pq.Push(TaskPriority::High, MakeLambda(payload));
+        auto task = pq.Pop();
+        (*task)();
+    }
+    ReportAllocations(state, before);
+    state.SetLabel(lock_free ? "LockFreeQueue" : "BoundedQueue");
+}
+
+BENCHMARK(BM_PriorityQueueRoundTrip)->Arg(0)->Arg(1);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "future.hpp"
+
+namespace dispatcher::coro {
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+
+// Когда корутина Task завершается, управление сразу переходит ожидающей ее корутине (symmetric transfer), без
+// рекурсии по стеку и без планирования отдельной задачи.
+struct FinalAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        if(auto continuation = handle.promise().continuation) {
+            return continuation;
+        }
+        return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+template<typename T>
+struct TaskPromise {
+    using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    std::coroutine_handle<> continuation;
+    std::variant<std::monostate, Value, std::exception_ptr> result;
+
+    Task<T> get_return_object() noexcept;
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    template<typename U = T>
+        requires(!std::is_void_v<T> && std::is_convertible_v<U &&, T>)
+    void return_value(U&& value) {
+        result.template emplace<1>(std::forward<U>(value));
+    }
+
+    void unhandled_exception() noexcept {
+        result.template emplace<2>(std::current_exception());
+    }
+
+    T Take() {
+        if(auto* error = std::get_if<2>(&result)) {
+            std::rethrow_exception(*error);
+        }
+        return std::move(std::get<1>(result));
+    }
+};
+
+template<>
+struct TaskPromise<void> {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    Task<void> get_return_object() noexcept;
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void return_void() const noexcept {}
+
+    void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+
+    void Take() const {
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+}  // namespace detail
+
+// Ленивая корутина с результатом T: тело начинает выполняться только при co_await (или в Start()/SyncWait()), а по
+// завершении сразу продолжает ожидающую корутину. На каком потоке выполняется тело, решают ожидания внутри него:
+// после co_await dispatcher.ScheduleOn(priority) - на воркере диспетчера. Исключение из тела пробрасывается из
+// co_await.
+template<typename T>
+class [[nodiscard]] Task {
+    public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task() = default;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept: handle_(handle) {}
+
+    Task(Task&& other) noexcept: handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if(this != &other) {
+            Reset();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        Reset();
+    }
+
+    bool Valid() const noexcept {
+        return handle_ != nullptr;
+    }
+
+    bool IsReady() const noexcept {
+        return !handle_ || handle_.done();
+    }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter: CompletionAwaiter {
+            T await_resume() {
+                return this->handle.promise().Take();
+            }
+        };
+        return Awaiter {{handle_}};
+    }
+
+    // Ожидание без забирания результата: корутина выполняется, а результат остается в ней до Take() (см. WhenAll()).
+    auto Completion() noexcept {
+        return CompletionAwaiter {handle_};
+    }
+
+    // Результат завершенной корутины. Вызывается один раз.
+    T Take() {
+        return handle_.promise().Take();
+    }
+
+    private:
+    struct CompletionAwaiter {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() const noexcept {
+            return handle.done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    void Reset() noexcept {
+        if(handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_ = nullptr;
+};
+
+namespace detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+// Корутина, которую никто не ждет: начинает выполняться сразу и сама освобождает кадр по завершении.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() const noexcept {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() const noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept {
+            return {};
+        }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept {
+            std::terminate();  // Исключения перехватываются в теле и уходят в Promise.
+        }
+    };
+};
+
+template<typename T>
+Detached Fulfill(Task<T> task, Promise<T> promise) {
+    try {
+        if constexpr(std::is_void_v<T>) {
+            co_await std::move(task);
+            promise.SetValue();
+        }
+        else {
+            promise.SetValue(co_await std::move(task));
+        }
+    }
+    catch(...) {
+        promise.SetException(std::current_exception());
+    }
+}
+
+// Общий счетчик WhenAll(): последняя завершившаяся корутина продолжает ожидающую.
+struct WhenAllLatch {
+    std::atomic<size_t> count {0};
+    std::coroutine_handle<> continuation;
+
+    bool Arrive() noexcept {
+        return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+};
+
+// Обертка одной корутины WhenAll(): ждет ее завершения и отмечается в счетчике.
+class WhenAllNotifier {
+    public:
+    struct promise_type {
+        WhenAllLatch* latch = nullptr;
+
+        WhenAllNotifier get_return_object() noexcept {
+            return WhenAllNotifier(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        auto final_suspend() const noexcept {
+            struct Awaiter {
+                bool await_ready() const noexcept {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    auto* latch = handle.promise().latch;
+                    return latch->Arrive() ? latch->continuation : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+            return Awaiter {};
+        }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept {
+            std::terminate();  // Completion() не бросает: исключение остается в ожидаемой корутине.
+        }
+    };
+
+    explicit WhenAllNotifier(std::coroutine_handle<promise_type> handle) noexcept: handle_(handle) {}
+
+    WhenAllNotifier(WhenAllNotifier&& other) noexcept: handle_(std::exchange(other.handle_, nullptr)) {}
+
+    WhenAllNotifier(const WhenAllNotifier&)            = delete;
+    WhenAllNotifier& operator=(const WhenAllNotifier&) = delete;
+    WhenAllNotifier& operator=(WhenAllNotifier&&)      = delete;
+
+    ~WhenAllNotifier() {
+        if(handle_) {
+            handle_.destroy();
+        }
+    }
+
+    void Start(WhenAllLatch& latch) noexcept {
+        handle_.promise().latch = &latch;
+        handle_.resume();
+    }
+
+    private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template<typename T>
+WhenAllNotifier Notify(Task<T>& task) {
+    co_await task.Completion();
+}
+
+// Запускает все корутины по очереди и приостанавливает ожидающую, пока не завершится последняя. Одна лишняя единица
+// счетчика принадлежит самому ожиданию: если все корутины завершились синхронно, ожидающая продолжается без
+// приостановки.
+class WhenAllAwaiter {
+    public:
+    explicit WhenAllAwaiter(std::vector<WhenAllNotifier> notifiers): notifiers_(std::move(notifiers)) {}
+
+    bool await_ready() const noexcept {
+        return notifiers_.empty();
+    }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        latch_.continuation = awaiting;
+        latch_.count.store(notifiers_.size() + 1, std::memory_order_relaxed);
+        for(auto& notifier: notifiers_) {
+            notifier.Start(latch_);
+        }
+        return !latch_.Arrive();
+    }
+
+    void await_resume() const noexcept {}
+
+    private:
+    std::vector<WhenAllNotifier> notifiers_;
+    WhenAllLatch latch_;
+};
+
+template<typename T>
+using NonVoid = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+template<typename T>
+NonVoid<T> TakeNonVoid(Task<T>& task) {
+    if constexpr(std::is_void_v<T>) {
+        task.Take();
+        return {};
+    }
+    else {
+        return task.Take();
+    }
+}
+
+}  // namespace detail
+
+// Запускает корутину на текущем потоке (до первой приостановки) и возвращает Future с ее результатом.
+template<typename T>
+Future<T> Start(Task<T> task) {
+    Promise<T> promise;
+    auto future = promise.GetFuture();
+    detail::Fulfill(std::move(task), std::move(promise));
+    return future;
+}
+
+// Запускает корутину и блокирует текущий поток до ее завершения. Не вызывать из воркера: он не сможет выполнять задачи,
+// которых ждет корутина.
+template<typename T>
+T SyncWait(Task<T> task) {
+    return Start(std::move(task)).Get();
+}
+
+// Fan-out/fan-in: ждет завершения всех корутин и возвращает их результаты (для void - std::monostate). Корутины
+// запускаются по очереди на текущем потоке, поэтому параллельно они выполняются, только если сами уходят на воркеры
+// (co_await dispatcher.ScheduleOn()). Если корутины выбросили исключения, пробрасывается исключение первой из них.
+template<typename... Ts>
+Task<std::tuple<detail::NonVoid<Ts>...>> WhenAll(Task<Ts>... tasks) {
+    std::vector<detail::WhenAllNotifier> notifiers;
+    notifiers.reserve(sizeof...(Ts));
+    (notifiers.push_back(detail::Notify(tasks)), ...);
+    co_await detail::WhenAllAwaiter(std::move(notifiers));
+    co_return std::tuple<detail::NonVoid<Ts>...> {detail::TakeNonVoid(tasks)...};
+}
+
+template<typename T>
+Task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> WhenAll(std::vector<Task<T>> tasks) {
+    std::vector<detail::WhenAllNotifier> notifiers;
+    notifiers.reserve(tasks.size());
+    for(auto& task: tasks) {
+        notifiers.push_back(detail::Notify(task));
+    }
+    co_await detail::WhenAllAwaiter(std::move(notifiers));
+    if constexpr(std::is_void_v<T>) {
+        for(auto& task: tasks) {
+            task.Take();
+        }
+    }
+    else {
+        std::vector<T> results;
+        results.reserve(tasks.size());
+        for(auto& task: tasks) {
+            results.push_back(task.Take());
+        }
+        co_return results;
+    }
+}
+
+}  // namespace dispatcher::coro
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace dispatcher {
+
+template<typename T>
+class Future;
+
+template<typename T>
+class Promise;
+
+namespace detail {
+
+// Общее состояние пары Promise/Future. Создается одним make_shared, результат лежит прямо в нем, а ожидание сделано
+// на std::atomic::wait() - без мьютекса и condition_variable, как у std::future.
+template<typename T>
+struct FutureState {
+    using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    std::variant<std::monostate, Value, std::exception_ptr> result;
+    std::atomic<bool> ready {false};
+
+    template<size_t Index, typename... Args>
+    void Set(Args&&... args) {
+        result.template emplace<Index>(std::forward<Args>(args)...);
+        ready.store(true, std::memory_order_release);  // Публикуем результат для потока в Future::Wait().
+        ready.notify_all();
+    }
+};
+
+}  // namespace detail
+
+// Легковесный аналог std::future: одна аллокация общего состояния на задачу. Результат забирается один раз через Get().
+template<typename T>
+class Future {
+    std::shared_ptr<detail::FutureState<T>> state_;
+
+    explicit Future(std::shared_ptr<detail::FutureState<T>> state): state_(std::move(state)) {}
+
+    friend class Promise<T>;
+
+    public:
+    Future() = default;
+
+    bool Valid() const noexcept {
+        return state_ != nullptr;
+    }
+
+    // IsReady(), Wait() и Get() у невалидного Future (созданного по умолчанию или после Get()) бросают
+    // std::future_error с кодом no_state, как std::future.
+    bool IsReady() const {
+        CheckState();
+        return state_->ready.load(std::memory_order_acquire);
+    }
+
+    void Wait() const {
+        CheckState();
+        state_->ready.wait(false, std::memory_order_acquire);
+    }
+
+    // Дожидается результата и возвращает его или пробрасывает исключение задачи. После вызова Future невалиден.
+    T Get() {
+        Wait();
+        auto state = std::move(state_);
+        if(auto* error = std::get_if<std::exception_ptr>(&state->result)) {
+            std::rethrow_exception(*error);
+        }
+        if constexpr(!std::is_void_v<T>) {
+            return std::move(std::get<1>(state->result));
+        }
+    }
+
+    private:
+    void CheckState() const {
+        if(!state_) {
+            throw std::future_error(std::future_errc::no_state);
+        }
+    }
+};
+
+// Сторона, выставляющая результат. Если Promise разрушен без результата (задача так и не была выполнена), Future
+// получает std::future_error с кодом broken_promise, а не ждет вечно.
+template<typename T>
+class Promise {
+    std::shared_ptr<detail::FutureState<T>> state_;
+
+    public:
+    Promise(): state_(std::make_shared<detail::FutureState<T>>()) {}
+
+    Promise(Promise&&) noexcept            = default;
+    Promise& operator=(Promise&&) noexcept = default;
+
+    Promise(const Promise&)            = delete;
+    Promise& operator=(const Promise&) = delete;
+
+    ~Promise() {
+        if(state_ && !state_->ready.load(std::memory_order_relaxed)) {
+            SetException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+    }
+
+    Future<T> GetFuture() const {
+        return Future<T>(state_);
+    }
+
+    template<typename... Args>
+    void SetValue(Args&&... args) {
+        state_->template Set<1>(std::forward<Args>(args)...);
+    }
+
+    void SetException(std::exception_ptr error) {
+        state_->template Set<2>(std::move(error));
+    }
+
+    // Вызывает f и кладет в Future ее результат или выброшенное ею исключение.
+    template<typename F>
+    void Fulfill(F& f) noexcept {
+        try {
+            if constexpr(std::is_void_v<T>) {
+                f();
+                SetValue();
+            }
+            else {
+                SetValue(f());
+            }
+        }
+        catch(...) {
+            SetException(std::current_exception());
+        }
+    }
+};
+
+}  // namespace dispatcher
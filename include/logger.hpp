@@ -1,30 +1,124 @@
 #pragma once
 
+#include "types.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <format>
 #include <memory>
-#include <string>
+#include <mutex>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct LoggerOptions {
+    // Синхронный режим: каждое сообщение - отдельная запись в небуферизованный файл прямо в вызывающем потоке.
+    // Асинхронный: поток дописывает сообщение в свой кольцевой буфер без блокировок, а фоновый поток раз в
+    // flush_interval (или раньше, если буфер наполовину заполнен) сбрасывает буферы всех потоков одним writev().
+    bool async {false};
+
+    // Емкость буфера потока в байтах, округляется вверх до степени двойки. Когда буфер полон, поток недолго ждет
+    // фоновый поток, а затем сбрасывает буферы сам.
+    size_t buffer_size {64 * 1024};
+    std::chrono::milliseconds flush_interval {1};
+};
 
 class Logger {
     public:
     static Logger& Get() {
-        static Logger instance;
+        static Logger instance(stdout, options_);
         return instance;
     }
 
-    void Log(const std::string& message) {
-        fprintf(file_, "%s\n", message.c_str());
+    // Задает режим логгера Get(). Действует, только если вызвана до первого Get().
+    static void Configure(LoggerOptions options) {
+        options_ = options;
+    }
+
+    explicit Logger(FILE* file, LoggerOptions options = {});
+
+    // Сообщение в формате std::format. Короткие сообщения форматируются в буфер на стеке, без аллокаций.
+    template<typename Arg, typename... Args>
+    void Log(std::format_string<Arg, Args...> format, Arg&& arg, Args&&... args) {
+        std::array<char, kInlineMessage> buffer;
+        const auto result = std::format_to_n(buffer.data(), static_cast<std::ptrdiff_t>(buffer.size()), format,
+                                             std::forward<Arg>(arg), std::forward<Args>(args)...);
+        if(static_cast<size_t>(result.size) <= buffer.size()) {
+            Log(std::string_view(buffer.data(), static_cast<size_t>(result.size)));
+            return;
+        }
+        Log(std::vformat(format.get(), std::make_format_args(arg, args...)));
     }
 
+    // Готовое сообщение, без форматирования. Перевод строки добавляется автоматически.
+    void Log(std::string_view message);
+
+    // Дожидается, пока все сообщения, записанные до вызова, не окажутся в файле.
+    void Flush();
+
     Logger(const Logger&)            = delete;
     Logger& operator=(const Logger&) = delete;
-    ~Logger()                        = default;
+    ~Logger();
 
     private:
-    Logger() {
-        file_ = stdout;
-        // отключаем буферизацию
-        setvbuf(file_, nullptr, _IONBF, 0);
-    }
+    static constexpr size_t kInlineMessage = 512;
+
+    // Сколько раз поток с полным буфером уступает процессор фоновому потоку, прежде чем сбросить буферы сам.
+    static constexpr int kFullBufferYields = 64;
+
+    // Кольцевой буфер потока: один писатель (поток-владелец) и один читатель (тот, кто держит drain_mutex_). Позиции
+    // только растут, сообщения лежат подряд вместе с переводами строк, поэтому непрочитанный хвост буфера - это не
+    // больше двух непрерывных кусков, которые уходят в writev() без копирования.
+    struct Buffer {
+        explicit Buffer(size_t capacity): data(std::make_unique<char[]>(capacity)), mask(capacity - 1) {}
 
+        std::unique_ptr<char[]> data;
+        const size_t mask;
+        std::thread::id owner;
+        std::atomic<bool> owned {true};  // false - поток-владелец завершился, буфер можно отдать другому потоку.
+
+        alignas(dispatcher::kCacheLineSize) std::atomic<uint64_t> head {0};  // Пишет только владелец.
+        alignas(dispatcher::kCacheLineSize) std::atomic<uint64_t> tail {0};  // Пишет только читатель.
+    };
+
+    inline static LoggerOptions options_ {};
+    inline static std::atomic<uint64_t> next_id_ {1};
+
+    const uint64_t id_ = next_id_.fetch_add(1, std::memory_order_relaxed);  // По нему поток находит свой буфер.
     FILE* file_;
+    const bool async_;
+    const size_t capacity_;
+    const std::chrono::milliseconds flush_interval_;
+
+    std::mutex buffers_mutex_;  // Защищает только список буферов.
+    std::vector<std::shared_ptr<Buffer>> buffers_;
+
+    std::mutex drain_mutex_;  // Читатель буферов: фоновый поток или Flush().
+
+    // Под drain_mutex_: переиспользуются от сброса к сбросу.
+    std::vector<std::shared_ptr<Buffer>> draining_;
+    std::vector<std::string_view> chunks_;
+    std::vector<uint64_t> heads_;
+
+    std::mutex flusher_mutex_;
+    std::condition_variable_any flusher_cv_;
+    std::jthread flusher_;
+
+    Buffer& Local();
+
+    // Дописывает сообщение и перевод строки в буфер потока.
+    void Append(std::string_view message);
+
+    // Пишет в файл все, что накопилось в буферах.
+    void Drain();
+    void DrainLocked();
+
+    void RunFlusher(std::stop_token stop);
 };
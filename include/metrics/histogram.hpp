@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace dispatcher::metrics {
+
+struct HistogramSnapshot;
+
+// Гистограмма латентностей в наносекундах в стиле HDR: корзины идут по степеням двойки, каждая степень делится на
+// kSubBuckets равных частей. Поэтому относительная погрешность не превышает 1 / kSubBuckets на всем диапазоне
+// uint64_t, а сама гистограмма - фиксированный массив без аллокаций в Record().
+//
+// У гистограммы один писатель (поток-владелец), читать ее можно из любого потока, поэтому Record() обходится
+// relaxed-чтением и записью без атомарных RMW-операций.
+class LatencyHistogram {
+    public:
+    static constexpr size_t kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets    = size_t {1} << kSubBucketBits;
+    static constexpr size_t kBuckets       = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    static size_t BucketIndex(uint64_t value);
+
+    // Нижняя граница значений, попадающих в корзину.
+    static uint64_t BucketLowerBound(size_t index);
+
+    void Record(uint64_t value);
+
+    // Добавляет текущие значения в снимок.
+    void AddTo(HistogramSnapshot& snapshot) const;
+
+    private:
+    static void Bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_ {};
+    std::atomic<uint64_t> count_ {0};
+    std::atomic<uint64_t> sum_ {0};
+    std::atomic<uint64_t> max_ {0};
+};
+
+// Снимок гистограммы: обычные счетчики, которые можно складывать и по которым считаются перцентили.
+struct HistogramSnapshot {
+    std::array<uint64_t, LatencyHistogram::kBuckets> buckets {};
+    uint64_t count = 0;
+    uint64_t sum   = 0;
+    uint64_t max   = 0;
+
+    // Значение q-го перцентиля (q из [0, 1]): верхняя граница его корзины, но не больше max. Для пустой - 0.
+    uint64_t Percentile(double q) const;
+
+    double Mean() const {
+        return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count);
+    }
+};
+
+}  // namespace dispatcher::metrics
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "metrics/histogram.hpp"
+#include "task.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace dispatcher::metrics {
+
+struct LevelSnapshot {
+    TaskPriority priority {};
+    uint64_t enqueued  = 0;
+    uint64_t started   = 0;
+    uint64_t completed = 0;
+    uint64_t failed    = 0;  // Задача выбросила исключение в воркер. Исключения задач из Submit() уходят в Future.
+    uint64_t discarded = 0;  // Не принята или вытеснена из очереди политикой переполнения.
+    uint64_t depth     = 0;  // Запланировано, но еще не начато и не отброшено.
+    HistogramSnapshot wait;  // Время от планирования до начала выполнения, нс.
+    HistogramSnapshot run;   // Время выполнения, нс.
+};
+
+struct WorkerSnapshot {
+    std::thread::id thread;
+    uint64_t executed = 0;
+    std::chrono::nanoseconds busy {0};
+};
+
+struct Snapshot {
+    std::vector<LevelSnapshot> levels;  // Только сконфигурированные уровни, от высшего приоритета к низшему.
+    std::vector<WorkerSnapshot> workers;
+};
+
+// Метрики диспетчера. Счетчики не делятся между потоками: число запланированных задач копится в полосах, выбираемых по
+// потоку-производителю, а все, что считают воркеры, - в собственной статистике каждого воркера с единственным
+// писателем. Поэтому учет не добавляет конкуренции ни в PriorityQueue::Push(), ни в цикл воркера, а Snapshot() только
+// суммирует полосы и статистики воркеров.
+class Metrics {
+    struct LevelStats {
+        std::atomic<uint64_t> started {0};
+        std::atomic<uint64_t> completed {0};
+        std::atomic<uint64_t> failed {0};
+        LatencyHistogram wait;
+        LatencyHistogram run;
+    };
+
+    struct ThreadStats {
+        std::thread::id thread;
+        std::atomic<uint64_t> executed {0};
+        std::atomic<uint64_t> busy_ns {0};
+        std::array<std::unique_ptr<LevelStats>, kMaxPriorityLevels> levels;  // Только сконфигурированные уровни.
+    };
+
+    static constexpr size_t kStripes = 16;
+
+    struct alignas(kCacheLineSize) Stripe {
+        std::array<std::atomic<uint64_t>, kMaxPriorityLevels> enqueued {};
+        std::array<std::atomic<uint64_t>, kMaxPriorityLevels> discarded {};
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    const uint64_t id_;  // Уникален среди всех экземпляров: по нему поток находит свою статистику в кэше.
+    std::vector<TaskPriority> priorities_;
+    std::array<Stripe, kStripes> stripes_ {};
+
+    std::mutex mutex_;  // Защищает только список статистик потоков.
+    std::vector<std::unique_ptr<ThreadStats>> threads_;
+
+    ThreadStats& Local();
+
+    void Run(TaskPriority priority, Clock::time_point enqueued, Task& task);
+
+    static void Bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    public:
+    explicit Metrics(std::span<const TaskPriority> priorities);
+
+    Metrics(const Metrics&)            = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // Учитывает планирование задачи и оборачивает ее: обертка замеряет ожидание и выполнение. Обертка не помещается во
+    // встроенный буфер Task, поэтому включенные метрики стоят одной аллокации на задачу.
+    Task Instrument(TaskPriority priority, Task task);
+
+    // Учитывает задачи уровня, которые так и не будут выполнены (см. queue::OverflowPolicy).
+    void Discard(TaskPriority priority, uint64_t count = 1);
+
+    Snapshot Collect();
+};
+
+}  // namespace dispatcher::metrics
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+namespace dispatcher::detail {
+
+struct ParallelRegion;
+
+// Участок итераций ParallelFor()/ParallelReduce(), которым владеет один поток. Next() отдает его частями по grain
+// итераций и перед каждой частью применяет ленивое двоичное разбиение: если в очередях TaskDispatcher нет ни одной
+// задачи, то свободным воркерам нечего взять, и вторая половина остатка отщепляется в отдельную задачу. Пока воркеры
+// заняты, отщепленная половина лежит в очереди, и участки больше не делятся. Поэтому цикл делится ровно настолько,
+// насколько есть кому его выполнять, а не на фиксированное число частей.
+class ParallelCursor {
+    public:
+    ParallelCursor(ParallelRegion& region, size_t begin, size_t end): region_(region), begin_(begin), end_(end) {}
+
+    // Следующая часть [begin, end). false - участок кончился или другой участок выбросил исключение.
+    bool Next(size_t& begin, size_t& end);
+
+    private:
+    // Отщепляет вторую половину остатка в задачу TaskDispatcher.
+    void Fork();
+
+    ParallelRegion& region_;
+    size_t begin_;
+    size_t end_;
+};
+
+// Тело цикла без типов: обходит свой участок через ParallelCursor, копя результат участка, и в конце учитывает его.
+class ParallelBody {
+    public:
+    virtual void Segment(ParallelCursor& cursor) = 0;
+
+    protected:
+    ~ParallelBody() = default;
+};
+
+}  // namespace dispatcher::detail
@@ -1,29 +1,45 @@
 #pragma once
 
 #include "queue/queue.hpp"
+#include "queue/task_storage.hpp"
+#include "types.hpp"
 
 #include <condition_variable>
-#include <functional>
 #include <mutex>
-#include <queue>
 
 namespace dispatcher::queue {
 
-class BoundedQueue: public IQueue {
+// Очередь выровнена по кэш-линии, чтобы соседние в памяти очереди (например, уровни PriorityQueue) не делили линии.
+// Мьютекс и данные очереди меняются вместе под мьютексом и лежат рядом. Условные переменные вынесены на свои линии:
+// not_empty_ будят производители после вставки, not_full_ - потребители после извлечения, и уведомления, которые
+// делаются уже без мьютекса, не инвалидируют линию с мьютексом и линию противоположной стороны.
+class alignas(kCacheLineSize) BoundedQueue: public IQueue {
     std::mutex mutex_;
-    std::condition_variable not_full_;
-    std::condition_variable not_empty_;
-    size_t capacity_;
-    std::queue<std::function<void()>> queue_;
+    TaskRing queue_;
+
+    alignas(kCacheLineSize) std::condition_variable not_full_;   // Ждут производители.
+    alignas(kCacheLineSize) std::condition_variable not_empty_;  // Ждут потребители.
 
     public:
     explicit BoundedQueue(int capacity);
 
-    void Push(std::function<void()> task) override;
+    void Push(Task task) override;
+
+    bool TryPush(Task& task) override;
+
+    bool PushFor(Task& task, std::chrono::nanoseconds timeout) override;
+
+    size_t PushDropOldest(Task task) override;
+
+    size_t PushBatch(std::span<Task> tasks) override;
+
+    size_t TryPopBatch(std::span<Task> out) override;
+
+    size_t Size() override;
 
-    std::optional<std::function<void()>> TryPop() override;
+    std::optional<Task> TryPop() override;
 
-    std::optional<std::function<void()>> Pop() override;
+    std::optional<Task> Pop() override;
 };
 
 }  // namespace dispatcher::queue
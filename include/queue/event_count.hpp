@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace dispatcher::queue {
+
+// Примитив "eventcount": позволяет lock-free структурам парковать потоки только тогда, когда ждать действительно
+// нечего, а уведомляющей стороне - не делать системный вызов, если спящих потоков нет.
+//
+// Протокол ожидания:
+//     auto key = ec.PrepareWait();
+//     if(условие уже выполнено) { ec.CancelWait(); ... } else { ec.Wait(key); }
+class EventCount {
+    std::atomic<uint32_t> epoch_ {0};
+    std::atomic<uint32_t> waiters_ {0};
+
+    public:
+    uint32_t PrepareWait() {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // Парный барьер к барьеру в Notify*().
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    void CancelWait() {
+        waiters_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void Wait(uint32_t key) {
+        epoch_.wait(key, std::memory_order_seq_cst);  // Сразу вернется, если после PrepareWait() был Notify*().
+        waiters_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void NotifyOne() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiters_.load(std::memory_order_seq_cst) > 0) {
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+            epoch_.notify_one();
+        }
+    }
+
+    void NotifyAll() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiters_.load(std::memory_order_seq_cst) > 0) {
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+            epoch_.notify_all();
+        }
+    }
+};
+
+}  // namespace dispatcher::queue
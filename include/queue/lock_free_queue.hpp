@@ -0,0 +1,64 @@
+#pragma once
+
+#include "queue/event_count.hpp"
+#include "queue/queue.hpp"
+#include "types.hpp"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+namespace dispatcher::queue {
+
+// Ограниченная lock-free MPMC очередь на кольцевом буфере. Каждый слот хранит счетчик поколения (turn): производитель
+// ждет в слоте четного поколения, потребитель - нечетного. Поэтому производители и потребители синхронизируются только
+// на своем слоте и не делят между собой ни мьютекс, ни голову/хвост очереди.
+class LockFreeQueue: public IQueue {
+    struct alignas(kCacheLineSize) Slot {
+        std::atomic<size_t> turn {0};
+        Task task;
+    };
+
+    const size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+
+    // Голова и хвост лежат на разных кэш-линиях, чтобы производители и потребители не инвалидировали линии друг друга.
+    alignas(kCacheLineSize) std::atomic<size_t> head_ {0};  // Позиция для следующего Push.
+    alignas(kCacheLineSize) std::atomic<size_t> tail_ {0};  // Позиция для следующего Pop.
+
+    alignas(kCacheLineSize) EventCount not_full_;
+    alignas(kCacheLineSize) EventCount not_empty_;
+
+    size_t Index(size_t pos) const {
+        return pos % capacity_;
+    }
+
+    size_t Turn(size_t pos) const {
+        return pos / capacity_;
+    }
+
+    public:
+    explicit LockFreeQueue(int capacity);
+
+    // Неблокирующая вставка. Возвращает false, если очередь заполнена; в этом случае task остается нетронутой.
+    bool TryPush(Task& task) override;
+
+    void Push(Task task) override;
+
+    // У EventCount нет ожидания с таймаутом, поэтому здесь ожидание места - опрос с экспоненциальной паузой.
+    bool PushFor(Task& task, std::chrono::nanoseconds timeout) override;
+
+    size_t PushDropOldest(Task task) override;
+
+    size_t PushBatch(std::span<Task> tasks) override;
+
+    size_t TryPopBatch(std::span<Task> out) override;
+
+    size_t Size() override;
+
+    std::optional<Task> TryPop() override;
+
+    std::optional<Task> Pop() override;
+};
+
+}  // namespace dispatcher::queue
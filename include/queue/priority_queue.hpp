@@ -1,36 +1,302 @@
 #pragma once
 #include "queue/bounded_queue.hpp"
+#include "queue/lock_free_queue.hpp"
+#include "queue/sharded_queue.hpp"
+#include "queue/spin_wait.hpp"
+#include "queue/timer_wheel.hpp"
 #include "queue/unbounded_queue.hpp"
 #include "types.hpp"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
 
 namespace dispatcher::queue {
 
+// Чем закончилась постановка задачи в очередь (см. OverflowPolicy).
+enum class PushResult {
+    Pushed,         // Задача в очереди своего уровня.
+    Spilled,        // Задача ушла на нижний уровень.
+    DroppedOldest,  // Задача в очереди, самая старая задача уровня вытеснена.
+    Rejected,       // Очередь заполнена, задача не принята.
+    TimedOut,       // Место не освободилось за отведенное время, задача не принята.
+};
+
+// Сколько раз заполненная очередь уровня заставила применить политику переполнения. По этим счетчикам подбирают
+// емкости: частые blocked и spilled означают, что уровню не хватает места.
+struct OverflowStats {
+    uint64_t blocked        = 0;  // Производитель ждал места.
+    uint64_t rejected       = 0;
+    uint64_t timed_out      = 0;
+    uint64_t dropped_oldest = 0;  // Сколько задач вытеснено.
+    uint64_t spilled        = 0;  // Сколько задач уровня ушло ниже.
+};
+
 class PriorityQueue {
-    std::map<TaskPriority, std::unique_ptr<IQueue>> priority_queues_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    bool active_ {true};
+    // Поля сгруппированы по тому, кто их пишет, и разнесены по кэш-линиям: производители и потребители не должны
+    // инвалидировать линии друг друга. Первая группа после конструктора только читается.
+    std::map<TaskPriority, std::unique_ptr<IQueue>> priority_queues_;  // Владеет очередями; вне горячего пути.
+
+    // Горячий путь: очереди по индексу уровня и битовая маска уровней, в которых могут быть задачи. Бит ставится после
+    // каждой вставки и снимается лениво - когда Pop() находит очередь уровня пустой. Поэтому самый приоритетный
+    // непустой уровень находится одним countr_zero.
+    std::array<IQueue*, kMaxPriorityLevels> levels_ {};
+    std::array<OverflowPolicy, kMaxPriorityLevels> overflow_ {};  // Политики переполнения по уровням.
+    uint64_t strict_ {0};                                         // Уровни со строгим приоритетом (weight == 0).
+    uint64_t weighted_ {0};                                       // Уровни с весом.
+    uint64_t aged_ {0};                                           // Уровни со старением.
+
+    // Маску пишут и производители, и потребители, поэтому она на своей линии, а производитель не пишет в нее, если бит
+    // уже поднят (см. MarkNonEmpty()).
+    alignas(kCacheLineSize) std::atomic<uint64_t> non_empty_ {0};
+
+    // Когда пора запускать таймеры (Clock::rep от начала эпохи часов), kNoTimers - таймеров нет. Пишется под mutex_ и
+    // редко, а потребители читают его без мьютекса, поэтому он на одной линии с маской.
+    static constexpr TimerWheel::Clock::rep kNoTimers = TimerWheel::Clock::duration::max().count();
+    std::atomic<TimerWheel::Clock::rep> due_ {kNoTimers};
+
+    // Счетный семафор задач: сколько задач лежит в очередях уровней и еще не обещано ни одному потребителю.
+    // Производитель добавляет разрешение после вставки, потребитель забирает разрешение до обращения к очередям.
+    // Поэтому потребитель с разрешением точно найдет задачу, а без разрешения не трогает очередей и сразу засыпает.
+    alignas(kCacheLineSize) std::atomic<size_t> available_ {0};
+
+    // Медленный путь потребителей: сон, таймеры и состояние политики нестрогих уровней.
+    alignas(kCacheLineSize) std::mutex mutex_;
+    std::atomic<bool> active_ {true};   // Пишется только под mutex_ (см. Shutdown()).
+    std::atomic<size_t> sleeping_ {0};  // Сколько потоков спит в Pop() на cv_. Меняется только под mutex_ (см. Wake()).
+
+    // Состояние политики выбора уровня (см. QueueOptions::weight и QueueOptions::aging).
+    struct LevelPolicy {
+        uint32_t weight  = 0;
+        uint32_t credit  = 0;  // Сколько задач уровень еще может отдать в текущем раунде.
+        uint32_t aging   = 0;
+        uint32_t skipped = 0;  // Сколько решений подряд уровень был непуст, но обойден.
+    };
+
+    std::array<LevelPolicy, kMaxPriorityLevels> policy_ {};
+    uint64_t in_credit_ {0};  // Уровни с весом, у которых остался кредит в текущем раунде.
+    uint64_t starving_ {0};   // Уровни, исчерпавшие порог старения.
+
+    // Отложенные и периодические задачи.
+    struct Periodic {
+        Task task;
+        std::chrono::nanoseconds period;
+        TaskPriority priority;
+        TimerWheel::Clock::time_point next;  // Срок ближайшего запуска.
+        TimerId current = 0;                 // Таймер ближайшего запуска в timers_.
+        bool cancelled  = false;
+    };
+
+    TimerWheel timers_;
+    std::vector<TimerWheel::Expired> expired_;  // Буфер FireTimers(), переиспользуется между вызовами.
+    std::unordered_map<TimerId, std::shared_ptr<Periodic>> periodic_;  // По идентификатору из ScheduleEvery().
+
+    // Производители будят потребителей уже без мьютекса: условная переменная не делит линию с его состоянием.
+    alignas(kCacheLineSize) std::condition_variable cv_;
+
+    // Счетчики меняются только на пути переполнения, поэтому общие атомики не мешают обычной вставке.
+    struct OverflowCounters {
+        std::atomic<uint64_t> blocked {0};
+        std::atomic<uint64_t> rejected {0};
+        std::atomic<uint64_t> timed_out {0};
+        std::atomic<uint64_t> dropped_oldest {0};
+        std::atomic<uint64_t> spilled {0};
+    };
+
+    alignas(kCacheLineSize) std::array<OverflowCounters, kMaxPriorityLevels> overflow_counters_ {};
+
+    IQueue& Level(TaskPriority priority) const;
+
+    // Поднимает бит уровня после вставки. Пока уровень непуст, бит обычно уже поднят, и производитель только читает
+    // линию маски. Барьер отделяет вставку от чтения бита - в паре с барьером в ClearIfEmpty(): либо потребитель
+    // увидит задачу при повторной проверке, либо производитель увидит снятый бит и поднимет его.
+    void MarkNonEmpty(TaskPriority priority) {
+        const uint64_t bit = uint64_t {1} << static_cast<size_t>(priority);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if((non_empty_.load(std::memory_order_relaxed) & bit) == 0) {
+            non_empty_.fetch_or(bit, std::memory_order_seq_cst);
+        }
+    }
+
+    // Снимает бит пустого уровня. Задача, положенная между TryPop() и снятием бита, будет найдена повторной проверкой.
+    std::optional<Task> ClearIfEmpty(size_t level);
 
     public:
     explicit PriorityQueue(const std::map<TaskPriority, QueueOptions>& config);
 
-    void Push(TaskPriority priority, std::function<void()> task);
+    // Кладет задачу, при заполненной очереди применяя политику переполнения уровня. При Block ждет места сколько
+    // угодно; при Reject задача уничтожается, о чем говорит результат. Если dropped задан, в него пишется число
+    // задач, вытесненных политикой DropOldest (их может быть и ноль, и несколько).
+    PushResult Push(TaskPriority priority, Task task, size_t* dropped = nullptr);
+
+    // Как Push(), но никогда не ждет места: при Block заполненная очередь означает Rejected. Если задача не принята,
+    // task остается нетронутой.
+    PushResult TryPush(TaskPriority priority, Task& task, size_t* dropped = nullptr);
+
+    // Как Push(), но при Block ждет места не дольше timeout. Если задача не принята, task остается нетронутой.
+    PushResult PushFor(TaskPriority priority, Task& task, std::chrono::nanoseconds timeout, size_t* dropped = nullptr);
+
+    OverflowStats GetOverflowStats(TaskPriority priority) const;
+
+    // Политика переполнения уровня (см. QueueOptions::overflow).
+    OverflowPolicy GetOverflowPolicy(TaskPriority priority) const;
+
+    // Есть ли уровень priority в конфигурации. Набор уровней не меняется после конструктора.
+    bool HasLevel(TaskPriority priority) const;
+
+    // Кладет пачку задач одного приоритета: в неограниченную очередь - за один захват мьютекса, в ограниченную -
+    // частями по мере освобождения места (политика переполнения к пачкам не применяется). Разрешения на всю часть
+    // пачки добавляются одной операцией, и будится не больше воркеров, чем положено задач.
+    void PushBatch(TaskPriority priority, std::span<Task> tasks);
+
+    std::optional<Task> Pop();
+
+    // Как Pop(), но прежде чем уснуть, ждет появления задачи по правилам spin (см. SpinWait).
+    std::optional<Task> Pop(SpinWait& spin);
+
+    // Кладет задачу в очередь уровня priority не раньше чем через delay (с точностью до миллисекунды). Сработавшие
+    // таймеры переносят в очереди потоки, ждущие в Pop() и PopBatch(): они спят не дольше ближайшего срока. Поэтому
+    // задача может опоздать, пока все воркеры заняты. Таймеры, не сработавшие к Shutdown(), отбрасываются.
+    TimerId ScheduleAfter(std::chrono::nanoseconds delay, TaskPriority priority, Task task);
+
+    // Кладет задачу в очередь уровня priority каждые period, первый раз - через period. Следующий запуск планируется
+    // после завершения текущего, поэтому запуски одной задачи не пересекаются; пропущенные из-за задержки запуски не
+    // навёрстываются.
+    TimerId ScheduleEvery(std::chrono::nanoseconds period, TaskPriority priority, Task task);
+
+    // Отменяет таймер. Возвращает false, если таймер уже сработал или отменен. Для периодической задачи отменяет все
+    // будущие запуски, уже начатый запуск завершится.
+    bool CancelTimer(TimerId id);
+
+    // Результат PopBatch(): сколько задач забрано и из очереди какого приоритета.
+    struct Batch {
+        TaskPriority priority {};
+        size_t size {0};
+    };
 
-    std::optional<std::function<void()>> Pop();
+    // Как Pop(), но забирает в out до out.size() задач: сразу столько разрешений, сколько есть, и одним TryPopBatch()
+    // очереди уровня. Все задачи пачки берутся из самой приоритетной непустой очереди, так что задача High никогда не
+    // оказывается в пачке позади Normal; лишние разрешения возвращаются. Пустая пачка означает, что была команда
+    // Shutdown() и задач не осталось.
+    Batch PopBatch(std::span<Task> out);
+
+    Batch PopBatch(std::span<Task> out, SpinWait& spin);
+
+    // Неблокирующее извлечение задачи конкретного приоритета. Тоже по разрешению: задача, обещанная потребителю в
+    // Pop(), не будет забрана у него из-под носа без следа в счетчике. Как и Pop(), запускает подошедшие таймеры.
+    std::optional<Task> TryPop(TaskPriority priority);
+
+    // Для воркера, который ждет внешнее событие и пока выполняет задачи очереди (см. TaskGroup::Wait()): засыпает
+    // вместе с потребителями Pop(), пока нет свободных задач и pending не ноль. Обнуливший pending вызывает WakeAll().
+    void SleepWhile(const std::atomic<size_t>& pending);
+
+    // Будит всех спящих, если они есть. Парный вызов к SleepWhile(): без спящих - одно чтение атомика.
+    void WakeAll();
 
     void Shutdown();
 
+    // Сколько задач во всех очередях уровней, без отложенных (см. IQueue::Size()).
+    size_t Size() const;
+
+    // Сколько задач в очередях уровней еще не обещано ни одному потребителю. В отличие от Size() - одно чтение
+    // атомика, поэтому годится для частых проверок, есть ли у свободных воркеров что взять.
+    size_t Available() const {
+        return available_.load(std::memory_order_relaxed);
+    }
+
+    // Сколько потребителей спит в Pop(), не найдя задач.
+    size_t Sleeping() const {
+        return sleeping_.load(std::memory_order_relaxed);
+    }
+
+    // Все уровни со строгим приоритетом, без весов и старения.
+    bool IsStrict() const {
+        return weighted_ == 0 && aged_ == 0;
+    }
+
     // Для юнит-тестирования класса.
     auto& GetQueues() const {
         return priority_queues_;
     }
 
     ~PriorityQueue() = default;
+
+    private:
+    // Общая реализация Push(): timeout == nullopt - ждать сколько угодно, нулевой - не ждать.
+    PushResult Admit(TaskPriority priority, Task& task, std::optional<std::chrono::nanoseconds> timeout,
+                     size_t* dropped);
+
+    // count задач легли в очередь уровня: поднимаем его бит и добавляем разрешения. Бит поднимается раньше, поэтому
+    // потребитель, получивший разрешение, найдет уровень по маске.
+    void Publish(size_t level, size_t count) {
+        MarkNonEmpty(PriorityLevel(level));
+        available_.fetch_add(count, std::memory_order_release);
+    }
+
+    // То же и будим воркера.
+    void Published(size_t level) {
+        Publish(level, 1);
+        Wake(1);
+    }
+
+    // Забирает до count разрешений и возвращает их число; 0 - задач нет. Не блокируется.
+    size_t Acquire(size_t count);
+
+    // Возвращает неиспользованные разрешения и будит за них спящих.
+    void Release(size_t count) {
+        available_.fetch_add(count, std::memory_order_release);
+        Wake(count);
+    }
+
+    // Будит до count спящих потребителей. Если спящих нет, не трогает ни мьютекс, ни cv_. Иначе сперва захватывает
+    // mutex_: потребитель объявляет себя спящим под мьютексом и отпускает его только в cv_.wait(), поэтому уведомление
+    // не проскочит мимо него (см. Sleep()).
+    void Wake(size_t count);
+
+    // Забирает задачи по out.size() разрешениям, которые уже получены, и возвращает лишние. Пачка не бывает пустой.
+    Batch Take(std::span<Task> out);
+
+    // Строгие уровни: самый приоритетный непустой уровень находится по маске, и состояния политики нет, поэтому
+    // mutex_ не нужен. Пустая пачка - задачу обещанного разрешения пока забрал кто-то другой.
+    Batch TakeStrict(std::span<Task> out);
+
+    // Забирает задачи уровня в out, снимая его бит, если он пуст. Возвращает число забранных задач.
+    size_t TakeFrom(size_t level, std::span<Task> out);
+
+    // Выбирает уровень по политике и забирает из него задачи. Вызывается под mutex_. Пустая пачка - все очереди пусты.
+    Batch TakeLocked(std::span<Task> out);
+
+    // Списывает с уровня кредит раунда и обновляет счетчики старения остальных уровней.
+    void Charge(size_t level, size_t popped);
+
+    // Ставит таймер. Вызывается под mutex_. Если срок раньше всех прочих, будит спящих, чтобы они ждали до него.
+    TimerId Arm(TimerWheel::Clock::time_point deadline, TaskPriority priority, Task task);
+
+    // Переносит задачи сработавших таймеров в очереди уровней. Вызывается под mutex_.
+    void FireTimers();
+
+    // Запускает таймеры, если подошел срок. Без таймеров - одно чтение due_.
+    void FireDueTimers();
+
+    // Срок следующего поворота колеса для потребителей без мьютекса. Вызывается под mutex_.
+    void UpdateDue();
+
+    // Засыпает на cv_ до уведомления или до ближайшего срока таймера. Не засыпает, если после объявления себя спящим
+    // видит свободные разрешения: их производитель мог не увидеть спящих. С pending (см. SleepWhile()) не засыпает и
+    // при нулевом pending, а Shutdown() его не останавливает: ожидаемые задачи еще выполняются.
+    void Sleep(const std::atomic<size_t>* pending = nullptr);
+
+    // Запуск периодической задачи и планирование следующего.
+    void RunPeriodic(const std::shared_ptr<Periodic>& state);
+    void Rearm(const std::shared_ptr<Periodic>& state);
 };
 
 }  // namespace dispatcher::queue
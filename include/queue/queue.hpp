@@ -1,21 +1,70 @@
 #pragma once
 
-#include <functional>
+#include "task.hpp"
+
+#include <chrono>
+#include <cstdint>
 #include <optional>
+#include <span>
 
 namespace dispatcher::queue {
 
+// Что делает PriorityQueue, когда ограниченная очередь уровня заполнена.
+enum class OverflowPolicy {
+    Block,       // Производитель ждет места (для TrySchedule() - отказ, для ScheduleFor() - ожидание с таймаутом).
+    Reject,      // Задача отклоняется.
+    DropOldest,  // Самая старая задача уровня вытесняется и уничтожается без выполнения.
+    Spill,       // Задача уходит на ближайший нижний уровень, где есть место; если места нет нигде - как Block.
+};
+
 struct QueueOptions {
     bool bounded;
     std::optional<int> capacity;
+    bool lock_free {false};  // Для ограниченной очереди: lock-free кольцевой буфер вместо мьютекса.
+
+    // Политика выбора уровня в PriorityQueue::Pop(). weight == 0 - строгий приоритет: уровень обслуживается всегда,
+    // когда в нем есть задачи и нет задач выше. Уровни с weight > 0 делят очередь по взвешенному round-robin: за раунд
+    // уровень отдает не больше weight задач, после чего уступает менее приоритетным уровням до начала нового раунда.
+    uint32_t weight {0};
+
+    // Старение: если непустой уровень был обойден aging решений Pop() подряд, следующее решение отдается ему вне
+    // очереди. 0 - без старения.
+    uint32_t aging {0};
+
+    OverflowPolicy overflow {OverflowPolicy::Block};
+
+    // Шардированный уровень (см. ShardedQueue): shards независимых очередей, емкость ограниченной делится между ними
+    // с округлением вверх. Порядок FIFO внутри уровня соблюдается только приблизительно, зато производители и
+    // потребители почти не встречаются на мьютексах. 1 - обычная очередь.
+    size_t shards {1};
 };
 
 class IQueue {
     public:
-    virtual ~IQueue()                                     = default;
-    virtual void Push(std::function<void()> task)         = 0;
-    virtual std::optional<std::function<void()>> TryPop() = 0;
-    virtual std::optional<std::function<void()>> Pop()    = 0;
+    virtual ~IQueue()                    = default;
+    virtual void Push(Task task)         = 0;
+    virtual std::optional<Task> TryPop() = 0;
+    virtual std::optional<Task> Pop()    = 0;
+
+    // Неблокирующая вставка. Возвращает false, если очередь заполнена; в этом случае task остается нетронутой.
+    virtual bool TryPush(Task& task) = 0;
+
+    // Ждет места не дольше timeout. Возвращает false по таймауту; в этом случае task остается нетронутой.
+    virtual bool PushFor(Task& task, std::chrono::nanoseconds timeout) = 0;
+
+    // Кладет задачу, вытесняя при заполненной очереди самые старые. Возвращает число вытесненных задач.
+    virtual size_t PushDropOldest(Task task) = 0;
+
+    // Под одним захватом кладет столько задач из начала пачки, сколько помещается, и возвращает их число (задачи
+    // перемещаются). Блокируется, только если места нет совсем, поэтому для непустой пачки всегда кладет хотя бы одну.
+    virtual size_t PushBatch(std::span<Task> tasks) = 0;
+
+    // Под одним захватом забирает из начала очереди до out.size() задач в out и возвращает их число. Не блокируется.
+    virtual size_t TryPopBatch(std::span<Task> out) = 0;
+
+    // Сколько задач в очереди на момент вызова. Для наблюдения и масштабирования пула, не для синхронизации: пока
+    // результат дойдет до вызывающего, он может устареть.
+    virtual size_t Size() = 0;
 };
 
 }  // namespace dispatcher::queue
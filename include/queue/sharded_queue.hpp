@@ -0,0 +1,64 @@
+#pragma once
+
+#include "queue/queue.hpp"
+#include "types.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dispatcher::queue {
+
+// Очередь из нескольких независимых шардов (MultiQueue): производитель кладет задачу в случайный шард, потребитель
+// забирает из более длинного из двух случайных шардов. Потоки почти не встречаются на одних мьютексах, поэтому
+// пропускная способность растет с числом ядер, а платой служит порядок: FIFO соблюдается только внутри шарда.
+//
+// Пустой ответ TryPop() и TryPopBatch() надежен, как у обычной очереди: прежде чем его вернуть, обходятся все шарды.
+// Длины шардов - приблизительные счетчики на линии самого шарда, они нужны только для выбора из двух.
+class ShardedQueue: public IQueue {
+    struct alignas(kCacheLineSize) Shard {
+        std::unique_ptr<IQueue> queue;
+        std::atomic<int64_t> size {0};
+    };
+
+    std::vector<Shard> shards_;
+
+    // Индекс случайного шарда. Генератор у каждого потока свой.
+    size_t Pick() const;
+
+    // Шард для извлечения: более длинный из двух случайных.
+    size_t PickLonger() const;
+
+    public:
+    // Все шарды - очереди одного вида; общая емкость ограниченной очереди - сумма емкостей шардов.
+    explicit ShardedQueue(std::vector<std::unique_ptr<IQueue>> shards);
+
+    size_t ShardCount() const {
+        return shards_.size();
+    }
+
+    // Ждет места в случайном шарде, даже если в других оно есть. PriorityQueue прибегает к нему только после неудачного
+    // TryPush(), который пробует все шарды.
+    void Push(Task task) override;
+
+    bool TryPush(Task& task) override;
+
+    bool PushFor(Task& task, std::chrono::nanoseconds timeout) override;
+
+    size_t PushDropOldest(Task task) override;
+
+    // Пачка целиком уходит в один шард.
+    size_t PushBatch(std::span<Task> tasks) override;
+
+    size_t TryPopBatch(std::span<Task> out) override;
+
+    size_t Size() override;
+
+    std::optional<Task> TryPop() override;
+
+    // Ожидание с уступанием процессора. PriorityQueue его не вызывает: у нее свое ожидание без опроса.
+    std::optional<Task> Pop() override;
+};
+
+}  // namespace dispatcher::queue
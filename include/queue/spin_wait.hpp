@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace dispatcher::queue {
+
+// Подсказка процессору, что поток крутится в ожидании: снижает энергопотребление и не мешает соседнему
+// гиперпотоку.
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Сколько потребитель ждет задачу, прежде чем уснуть (см. PriorityQueue::Pop()). Нули - засыпать сразу.
+struct SpinOptions {
+    uint32_t spins  = 0;  // Наибольшее число проверок очереди с CpuRelax() между ними.
+    uint32_t yields = 0;  // Сколько раз после вращения уступить процессор std::this_thread::yield().
+};
+
+// Адаптивное ожидание одного потока-потребителя: вращение, затем уступание процессора, затем сон. Бюджет вращения
+// растет, когда вращение дождалось задачи, и сокращается вдвое, когда дело все равно кончилось сном. Поэтому при
+// частых коротких задачах поток не платит за засыпание и пробуждение, а простаивающий поток почти не жжет процессор.
+class SpinWait {
+    public:
+    static constexpr uint32_t kMinSpins = 16;
+
+    explicit SpinWait(SpinOptions options = {}): options_(options), budget_(options.spins) {}
+
+    bool Enabled() const {
+        return options_.spins > 0 || options_.yields > 0;
+    }
+
+    uint32_t Budget() const {
+        return budget_;
+    }
+
+    // Ждет, пока ready() не вернет true. Возвращает false, если не дождался: вызывающему пора засыпать.
+    template<typename Ready>
+    bool Wait(Ready&& ready) {
+        for(uint32_t i = 0; i < budget_; ++i) {
+            if(ready()) {
+                const uint64_t grown = std::max<uint64_t>(uint64_t {budget_} * 2, kMinSpins);
+                budget_              = static_cast<uint32_t>(std::min<uint64_t>(grown, options_.spins));
+                return true;
+            }
+            CpuRelax();
+        }
+        for(uint32_t i = 0; i < options_.yields; ++i) {
+            if(ready()) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        budget_ = std::max(budget_ / 2, std::min(kMinSpins, options_.spins));
+        return ready();
+    }
+
+    private:
+    SpinOptions options_;
+    uint32_t budget_;
+};
+
+}  // namespace dispatcher::queue
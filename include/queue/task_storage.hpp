@@ -0,0 +1,124 @@
+#pragma once
+
+#include "task.hpp"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+namespace dispatcher::queue {
+
+// Хранилища задач для очередей с мьютексом. В отличие от std::queue (std::deque), задачи лежат в непрерывных блоках,
+// а блоки не возвращаются в кучу после опустошения, поэтому в установившемся режиме вставка и извлечение не выделяют
+// память. Классы не потокобезопасны: очереди обращаются к ним под своим мьютексом.
+
+// Кольцевой буфер фиксированной емкости: вся память выделяется в конструкторе.
+class TaskRing {
+    std::unique_ptr<Task[]> slots_;
+    const size_t capacity_;
+    size_t head_ = 0;  // Индекс самой старой задачи.
+    size_t size_ = 0;
+
+    public:
+    explicit TaskRing(size_t capacity);
+
+    size_t Size() const {
+        return size_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    bool Full() const {
+        return size_ == capacity_;
+    }
+
+    // Кладет задачу в конец. Буфер не должен быть заполнен.
+    void Push(Task task) {
+        const size_t tail = head_ + size_;
+        slots_[tail < capacity_ ? tail : tail - capacity_] = std::move(task);
+        ++size_;
+    }
+
+    // Забирает самую старую задачу. Буфер не должен быть пуст; слот остается пустым и ничего не удерживает.
+    Task Pop() {
+        Task task = std::move(slots_[head_]);
+        head_     = head_ + 1 == capacity_ ? 0 : head_ + 1;
+        --size_;
+        return task;
+    }
+};
+
+// Растущая очередь из сегментов по kSegmentSize задач. Опустевшие сегменты уходят в список свободных и
+// переиспользуются; в кучу возвращаются только те, что не поместились в список (kMaxFreeSegments), - чтобы всплеск
+// нагрузки не удерживал память навсегда.
+class TaskSegmentList {
+    public:
+    static constexpr size_t kSegmentSize     = 32;
+    static constexpr size_t kMaxFreeSegments = 16;
+
+    TaskSegmentList() = default;
+
+    TaskSegmentList(const TaskSegmentList&)            = delete;
+    TaskSegmentList& operator=(const TaskSegmentList&) = delete;
+
+    ~TaskSegmentList();
+
+    size_t Size() const {
+        return size_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    void Push(Task task) {
+        if(!tail_ || tail_index_ == kSegmentSize) {
+            Grow();
+        }
+        tail_->tasks[tail_index_++] = std::move(task);
+        ++size_;
+    }
+
+    // Забирает самую старую задачу. Очередь не должна быть пуста.
+    Task Pop() {
+        Task task = std::move(head_->tasks[head_index_++]);
+        if(--size_ == 0) {
+            head_index_ = tail_index_ = 0;  // Опустевшая очередь снова пишет с начала сегмента: он уже в кэше.
+        }
+        else if(head_index_ == kSegmentSize) {
+            Shrink();
+        }
+        return task;
+    }
+
+    // Сколько сегментов выделено, включая свободные. Для юнит-тестирования.
+    size_t Segments() const {
+        return segments_;
+    }
+
+    private:
+    struct Segment {
+        std::array<Task, kSegmentSize> tasks;
+        Segment* next = nullptr;
+    };
+
+    // Добавляет в конец сегмент из списка свободных или новый.
+    void Grow();
+
+    // Отправляет вычерпанный головной сегмент в список свободных.
+    void Shrink();
+
+    Segment* head_     = nullptr;
+    Segment* tail_     = nullptr;
+    size_t head_index_ = 0;  // Позиция самой старой задачи в head_.
+    size_t tail_index_ = 0;  // Позиция для следующей задачи в tail_.
+    size_t size_       = 0;
+
+    Segment* free_     = nullptr;
+    size_t free_count_ = 0;
+    size_t segments_   = 0;
+};
+
+}  // namespace dispatcher::queue
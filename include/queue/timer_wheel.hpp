@@ -0,0 +1,106 @@
+#pragma once
+
+#include "task.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace dispatcher::queue {
+
+// Идентификатор таймера: индекс узла и его поколение. Поколение меняется при каждом переиспользовании узла, поэтому
+// старый идентификатор не отменит чужой таймер. 0 - не таймер.
+using TimerId = uint64_t;
+
+// Иерархическое колесо таймеров: kLevels колес по kSlots слотов, слот уровня L покрывает kSlots^L тиков. Таймер
+// кладется в слот по своему сроку, а при повороте старшего колеса его слот "осыпается" в младшие. Вставка и отмена -
+// O(1): узлы лежат в векторе и связаны в двусвязные списки слотов индексами. Пустые слоты отмечены битовыми масками,
+// поэтому простой колеса и поиск ближайшего срока обходятся без перебора слотов.
+//
+// Класс не потокобезопасен: PriorityQueue обращается к нему под своим мьютексом.
+class TimerWheel {
+    public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlots    = size_t {1} << kSlotBits;
+    static constexpr size_t kLevels   = 4;  // При тике в 1 мс колесо покрывает 64^4 мс - больше четырех часов.
+
+    struct Expired {
+        TaskPriority priority;
+        Task task;
+    };
+
+    explicit TimerWheel(Clock::duration tick = std::chrono::milliseconds(1), Clock::time_point origin = Clock::now());
+
+    // Таймер срабатывает не раньше deadline, с точностью до тика.
+    TimerId Add(Clock::time_point deadline, TaskPriority priority, Task task);
+
+    // Возвращает false, если таймер уже сработал или отменен.
+    bool Cancel(TimerId id);
+
+    // Поворачивает колесо до момента now и дописывает сработавшие таймеры в out.
+    void Expire(Clock::time_point now, std::vector<Expired>& out);
+
+    // Когда колесу нужно повернуться в следующий раз: срок ближайшего таймера или более ранний момент, когда таймеры
+    // старшего колеса осыплются в младшее. std::nullopt - таймеров нет.
+    std::optional<Clock::time_point> NextExpiry() const;
+
+    size_t Size() const {
+        return size_;
+    }
+
+    // Длительность тика: точность, с которой срабатывают таймеры.
+    Clock::duration Resolution() const {
+        return tick_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Node {
+        uint64_t deadline   = 0;  // В тиках от origin_.
+        uint32_t generation = 1;
+        uint32_t prev       = kNil;
+        uint32_t next       = kNil;  // Для свободного узла - следующий свободный.
+        uint8_t level       = 0;
+        uint8_t slot        = 0;
+        bool linked         = false;
+        TaskPriority priority {};
+        Task task;
+    };
+
+    static TimerId MakeId(uint32_t index, uint32_t generation) {
+        return (uint64_t {generation} << 32) | index;
+    }
+
+    void Place(uint32_t index);
+    void Link(uint32_t index, size_t level, size_t slot);
+    void Unlink(uint32_t index);
+    void Free(uint32_t index);
+
+    // Ближайший тик, на котором колесу есть что делать.
+    std::optional<uint64_t> NextTick() const;
+
+    // Обрабатывает тик now_: осыпает слоты старших колес, на границе которых он лежит, и забирает слот младшего.
+    void Tick(std::vector<Expired>& out);
+
+    Clock::duration tick_;
+    Clock::time_point origin_;
+    uint64_t now_ = 0;  // Последний обработанный тик.
+    size_t size_  = 0;
+
+    std::vector<Node> nodes_;
+    uint32_t free_ = kNil;
+    std::array<std::array<uint32_t, kSlots>, kLevels> heads_;
+    std::array<uint64_t, kLevels> occupied_ {};  // Бит - непустой слот.
+};
+
+}  // namespace dispatcher::queue
@@ -1,27 +1,42 @@
 #pragma once
 
 #include "queue/queue.hpp"
+#include "queue/task_storage.hpp"
+#include "types.hpp"
 
 #include <condition_variable>
-#include <functional>
 #include <optional>
 #include <mutex>
-#include <queue>
 
 namespace dispatcher::queue {
 
-class UnboundedQueue: public IQueue {
-    std::queue<std::function<void()>> queue_;
-    std::condition_variable not_empty_;
+// Раскладка по кэш-линиям - как у BoundedQueue: мьютекс рядом с данными, которые он защищает, условная переменная,
+// которую производители будят уже без мьютекса, - на своей линии.
+class alignas(kCacheLineSize) UnboundedQueue: public IQueue {
     std::mutex mutex_;
+    TaskSegmentList queue_;
+
+    alignas(kCacheLineSize) std::condition_variable not_empty_;
 
     public:
     UnboundedQueue() = default;
 
-    void Push(std::function<void()> task) override;
+    void Push(Task task) override;
+
+    bool TryPush(Task& task) override;
+
+    bool PushFor(Task& task, std::chrono::nanoseconds timeout) override;
+
+    size_t PushDropOldest(Task task) override;
+
+    size_t PushBatch(std::span<Task> tasks) override;
+
+    size_t TryPopBatch(std::span<Task> out) override;
+
+    size_t Size() override;
 
-    std::optional<std::function<void()>> Pop() override;
-    std::optional<std::function<void()>> TryPop() override;
+    std::optional<Task> Pop() override;
+    std::optional<Task> TryPop() override;
 };
 
 }  // namespace dispatcher::queue
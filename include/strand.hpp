@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "future.hpp"
+#include "task.hpp"
+#include "task_dispatcher.hpp"
+#include "types.hpp"
+
+namespace dispatcher {
+
+// Последовательный исполнитель поверх TaskDispatcher: задачи одного Strand выполняются строго по одной и в порядке
+// Schedule(), задачи разных Strand - параллельно. Заменяет мьютекс на сущность внутри задачи: воркеры не блокируются
+// друг на друге, очередь сущности ждет в самом Strand, не занимая воркеров.
+//
+// Пока у Strand нет задач, в TaskDispatcher его нет. Первая задача ставит в очередь уровня задачу-обработчик, которая
+// выполняет задачи Strand по порядку и завершается, когда они кончаются. Постановка задачи без блокировок: узел
+// добавляется в интрузивную MPSC-очередь, а счетчик задач решает, нужно ли запускать обработчик.
+//
+// Strand - дескриптор: копии ссылаются на одну очередь, а состояние живет, пока есть дескрипторы или задачи. Для
+// упорядочивания по ключу (например, по счету) заводят по Strand на ключ.
+//
+// Уровень Strand не может использовать политику DropOldest: вытесненный обработчик уже не запустится, а счетчик задач
+// не вернется к нулю, и Strand молча остановится. TaskDispatcher::MakeStrand() такие уровни отклоняет.
+class Strand {
+    public:
+    // Сколько задач обработчик выполняет подряд, прежде чем уступить воркера другим задачам уровня.
+    static constexpr size_t kDrainBatch = 64;
+
+    Strand() = default;
+
+    Strand(TaskDispatcher& dispatcher, TaskPriority priority);
+
+    // Ставит задачу в очередь Strand. Исключение задачи не останавливает Strand: оно печатается, как в воркере, и
+    // следующие задачи выполняются.
+    void Schedule(Task task);
+
+    // Ставит задачу в очередь Strand и возвращает Future с ее результатом (см. TaskDispatcher::Submit()).
+    template<typename F, typename R = std::invoke_result_t<std::decay_t<F>&>>
+    Future<R> Submit(F&& f) {
+        Promise<R> promise;
+        auto future = promise.GetFuture();
+        Schedule([promise = std::move(promise), f = std::forward<F>(f)]() mutable { promise.Fulfill(f); });
+        return future;
+    }
+
+    TaskPriority Priority() const {
+        return state_->priority;
+    }
+
+    bool Valid() const {
+        return state_ != nullptr;
+    }
+
+    private:
+    struct Node {
+        std::atomic<Node*> next {nullptr};
+        Task task;
+    };
+
+    // Очередь Вьюкова: производители только меняют tail и связывают узел с предыдущим, обработчик читает с head.
+    // Заглушка stub позволяет не различать пустую очередь и очередь из одного узла.
+    struct State {
+        explicit State(TaskDispatcher& dispatcher, TaskPriority priority);
+
+        State(const State&)            = delete;
+        State& operator=(const State&) = delete;
+        ~State();
+
+        TaskDispatcher* const dispatcher;
+        const TaskPriority priority;
+        Node stub;
+
+        alignas(kCacheLineSize) std::atomic<Node*> tail;          // Пишут производители.
+        alignas(kCacheLineSize) Node* head;                       // Только обработчик.
+        alignas(kCacheLineSize) std::atomic<size_t> pending {0};  // Задачи, поставленные и еще не выполненные.
+
+        void Push(Node* node);
+
+        // Следующий узел или nullptr, если производитель еще не связал свой узел с очередью.
+        Node* Pop();
+    };
+
+    // Ставит обработчик в общую очередь уровня. Если уровень отклонил его (политика Reject), обработчик выполняется
+    // на текущем потоке: иначе задачи Strand так и остались бы невыполненными.
+    static void Dispatch(const std::shared_ptr<State>& state);
+
+    // Выполняет до kDrainBatch задач. Возвращает true, если задачи остались и обработчик нужно запустить снова.
+    static bool Drain(State& state);
+
+    std::shared_ptr<State> state_;
+};
+
+}  // namespace dispatcher
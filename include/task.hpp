@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dispatcher {
+
+// Move-only обертка над вызываемым объектом void() с буфером на InlineSize байт внутри самого объекта. Типичные лямбды
+// (несколько указателей и чисел в захвате) размещаются в буфере без обращения к куче, крупные или бросающие при
+// перемещении объекты - в куче. В отличие от std::function, умеет хранить move-only объекты: std::packaged_task,
+// лямбды с std::unique_ptr в захвате и т.д.
+template<std::size_t InlineSize>
+class BasicTask {
+    struct VTable {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src) noexcept;  // Перемещает объект из src в dst и разрушает src.
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename F>
+    static constexpr bool kFitsInline = sizeof(F) <= InlineSize && alignof(F) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible_v<F>;
+
+    template<typename F>
+    static constexpr VTable kInlineVTable {
+        [](void* storage) { (*static_cast<F*>(storage))(); },
+        [](void* dst, void* src) noexcept {
+            ::new(dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        },
+        [](void* storage) noexcept { static_cast<F*>(storage)->~F(); }};
+
+    template<typename F>
+    static constexpr VTable kHeapVTable {
+        [](void* storage) { (**static_cast<F**>(storage))(); },
+        [](void* dst, void* src) noexcept { *static_cast<F**>(dst) = *static_cast<F**>(src); },
+        [](void* storage) noexcept { delete *static_cast<F**>(storage); }};
+
+    alignas(std::max_align_t) std::byte storage_[InlineSize];
+    const VTable* vtable_ = nullptr;
+
+    void Reset() noexcept {
+        if(vtable_) {
+            vtable_->destroy(storage_);
+            vtable_ = nullptr;
+        }
+    }
+
+    public:
+    static constexpr std::size_t kInlineSize = InlineSize;
+
+    BasicTask() noexcept = default;
+
+    BasicTask(std::nullptr_t) noexcept {}
+
+    template<typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, BasicTask> && std::is_invocable_v<std::decay_t<F>&>)
+    BasicTask(F&& f) {  // NOLINT(google-explicit-constructor): лямбды должны неявно превращаться в задачу.
+        using Fn = std::decay_t<F>;
+        if constexpr(kFitsInline<Fn>) {
+            ::new(static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+            vtable_ = &kInlineVTable<Fn>;
+        }
+        else {
+            ::new(static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(f)));
+            vtable_ = &kHeapVTable<Fn>;
+        }
+    }
+
+    BasicTask(BasicTask&& other) noexcept: vtable_(other.vtable_) {
+        if(vtable_) {
+            vtable_->move(storage_, other.storage_);
+            other.vtable_ = nullptr;
+        }
+    }
+
+    BasicTask& operator=(BasicTask&& other) noexcept {
+        if(this != &other) {
+            Reset();
+            if(other.vtable_) {
+                other.vtable_->move(storage_, other.storage_);
+                vtable_       = other.vtable_;
+                other.vtable_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    BasicTask& operator=(std::nullptr_t) noexcept {
+        Reset();
+        return *this;
+    }
+
+    BasicTask(const BasicTask&)            = delete;
+    BasicTask& operator=(const BasicTask&) = delete;
+
+    ~BasicTask() {
+        Reset();
+    }
+
+    void operator()() {
+        vtable_->invoke(storage_);
+    }
+
+    explicit operator bool() const noexcept {
+        return vtable_ != nullptr;
+    }
+
+    // Поместится ли объект типа F во встроенный буфер (без выделения памяти).
+    template<typename F>
+    static constexpr bool IsInline() {
+        return kFitsInline<std::decay_t<F>>;
+    }
+};
+
+// Размер встроенного буфера задачи по умолчанию: лямбда с захватом до восьми указателей не требует кучи.
+inline constexpr std::size_t kTaskInlineSize = 64;
+
+using Task = BasicTask<kTaskInlineSize>;
+
+}  // namespace dispatcher
@@ -1,7 +1,22 @@
 #pragma once
 
+#include <chrono>
+#include <concepts>
+#include <coroutine>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
+#include "coroutine.hpp"
+#include "future.hpp"
+#include "metrics/metrics.hpp"
+#include "parallel.hpp"
 #include "queue/priority_queue.hpp"
 #include "thread_pool/thread_pool.hpp"
 #include "types.hpp"
@@ -12,15 +27,265 @@ inline const std::map<TaskPriority, queue::QueueOptions> init_config = {
     {TaskPriority::High, queue::QueueOptions {true, 1000}},
     {TaskPriority::Normal, queue::QueueOptions {false, std::nullopt}}};
 
+class Strand;
+class TaskGroup;
+
 class TaskDispatcher {
     std::shared_ptr<queue::PriorityQueue> pq_    = nullptr;
+    std::unique_ptr<metrics::Metrics> metrics_   = nullptr;  // Объявлен раньше пула: задачи пула ссылаются на него.
     std::unique_ptr<thread_pool::ThreadPool> tp_ = nullptr;
 
+    // Общий путь Schedule*(): timeout == nullopt - ждать сколько угодно, нулевой - не ждать. local == false - не
+    // оставлять задачу в локальной очереди воркера (см. ThreadPool::TryPushLocal()).
+    bool Admit(TaskPriority priority, Task task, std::optional<std::chrono::nanoseconds> timeout, bool local = true);
+
+    // Бросает std::invalid_argument, если уровня priority нет. Для тех, кто запоминает уровень и ставит задачи позже:
+    // ошибка должна всплыть у вызывающего, а не в задаче воркера.
+    void CheckPriority(TaskPriority priority) const;
+
+    friend class Strand;  // Обработчик Strand уходит в общую очередь, мимо локальной очереди воркера.
+    friend class detail::ParallelCursor;  // Так же и отщепленные участки циклов.
+    friend class TaskGroup;               // Ожидание группы выполняет задачи пула (см. ThreadPool::RunPending()).
+
+    // Общий путь ParallelFor() и ParallelReduce(): выполняет body над [0, size) и возвращается, когда выполнены все
+    // участки. Вызывающий поток обходит свой участок, затем забирает отщепленные, которые еще не взял никто из
+    // воркеров, и только потом ждет чужие. Исключение первого упавшего участка пробрасывается.
+    void RunParallel(size_t size, size_t grain, TaskPriority priority, detail::ParallelBody& body);
+
+    template<typename T>
+    coro::Task<T> RunOn(TaskPriority priority, coro::Task<T> task) {
+        co_await ScheduleOn(priority);
+        co_return co_await std::move(task);
+    }
+
     public:
+    // Ожидание, после которого корутина продолжается на воркере. Задача в очереди - только дескриптор корутины во
+    // встроенном буфере Task, поэтому продолжение не выделяет памяти: состояние живет в кадре корутины.
+    class ScheduleAwaiter {
+        TaskDispatcher& dispatcher_;
+        TaskPriority priority_;
+        bool local_;
+        bool rejected_ = false;
+
+        public:
+        ScheduleAwaiter(TaskDispatcher& dispatcher, TaskPriority priority, bool local):
+            dispatcher_(dispatcher),
+            priority_(priority),
+            local_(local) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            // Как только задача в очереди, воркер может продолжить корутину и разрушить ожидание вместе с кадром,
+            // поэтому после успешного Admit() к полям обращаться нельзя.
+            if(dispatcher_.Admit(priority_, [handle] { handle.resume(); }, std::nullopt, local_)) {
+                return true;
+            }
+            rejected_ = true;
+            return false;
+        }
+
+        // Политика Reject отклонила продолжение: корутина продолжается на текущем потоке с исключением.
+        void await_resume() const {
+            if(rejected_) {
+                throw std::runtime_error("Coroutine continuation rejected by overflow policy");
+            }
+        }
+    };
+
+    // collect_metrics включает учет метрик (см. GetMetrics()). Без него задачи не оборачиваются и учет ничего не стоит.
     explicit TaskDispatcher(size_t thread_count,
-                            const std::map<TaskPriority, queue::QueueOptions>& config = init_config);
+                            const std::map<TaskPriority, queue::QueueOptions>& config = init_config,
+                            thread_pool::ThreadPoolOptions pool_options                = {},
+                            bool collect_metrics                                       = false);
+
+    // Планирует задачу. Если очередь уровня заполнена, действует политика переполнения из QueueOptions: при Block вызов
+    // ждет места, при Reject задача отбрасывается - тогда вызов возвращает false.
+    bool Schedule(TaskPriority priority, Task task);
+
+    // Никогда не ждет места в очереди. Возвращает false, если задача не принята (при Block и Reject - очередь
+    // заполнена).
+    bool TrySchedule(TaskPriority priority, Task task);
+
+    // Ждет места не дольше timeout (для политики Block). Возвращает false, если задача не принята.
+    template<typename Rep, typename Period>
+    bool ScheduleFor(TaskPriority priority, Task task, std::chrono::duration<Rep, Period> timeout) {
+        return ScheduleFor(priority, std::move(task), std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+    }
+
+    bool ScheduleFor(TaskPriority priority, Task task, std::chrono::nanoseconds timeout);
+
+    // Планирует задачу не раньше чем через delay (см. PriorityQueue::ScheduleAfter()). Возвращает идентификатор для
+    // CancelTimer(). Отложенные задачи не учитываются метриками: время ожидания включало бы задержку.
+    template<typename Rep, typename Period>
+    queue::TimerId ScheduleAfter(std::chrono::duration<Rep, Period> delay, TaskPriority priority, Task task) {
+        return ScheduleAfter(std::chrono::duration_cast<std::chrono::nanoseconds>(delay), priority, std::move(task));
+    }
+
+    queue::TimerId ScheduleAfter(std::chrono::nanoseconds delay, TaskPriority priority, Task task);
+
+    // Планирует задачу каждые period (см. PriorityQueue::ScheduleEvery()).
+    template<typename Rep, typename Period>
+    queue::TimerId ScheduleEvery(std::chrono::duration<Rep, Period> period, TaskPriority priority, Task task) {
+        return ScheduleEvery(std::chrono::duration_cast<std::chrono::nanoseconds>(period), priority, std::move(task));
+    }
+
+    queue::TimerId ScheduleEvery(std::chrono::nanoseconds period, TaskPriority priority, Task task);
+
+    // Отменяет отложенную или периодическую задачу. Возвращает false, если таймер уже сработал или отменен.
+    bool CancelTimer(queue::TimerId id);
+
+    // Счетчики исходов переполнения уровня: по ним подбирают емкости очередей.
+    queue::OverflowStats GetOverflowStats(TaskPriority priority) const;
+
+    // Настроен ли уровень priority (см. PriorityQueue::HasLevel()).
+    bool HasPriority(TaskPriority priority) const;
+
+    // Снимок метрик по уровням и воркерам или std::nullopt, если метрики не включены. Можно вызывать часто: снимок
+    // только суммирует счетчики и не блокирует ни производителей, ни воркеров.
+    std::optional<metrics::Snapshot> GetMetrics() const;
+
+    // Планирует задачу и возвращает Future с ее результатом. Исключение, выброшенное задачей, попадает в Future.
+    // Promise и f хранятся прямо в задаче, поэтому на задачу приходится одна аллокация - общее состояние Future.
+    template<typename F, typename R = std::invoke_result_t<std::decay_t<F>&>>
+    Future<R> Submit(TaskPriority priority, F&& f) {
+        Promise<R> promise;
+        auto future = promise.GetFuture();
+        Schedule(priority, [promise = std::move(promise), f = std::forward<F>(f)]() mutable { promise.Fulfill(f); });
+        return future;
+    }
+
+    // co_await ScheduleOn(priority) продолжает корутину на воркере с приоритетом priority. Как и Schedule(), из воркера
+    // в режиме work-stealing продолжение остается в его локальной очереди. Политика DropOldest может вытеснить
+    // продолжение, и тогда корутина не продолжится никогда - для уровней с корутинами ее лучше не использовать.
+    ScheduleAwaiter ScheduleOn(TaskPriority priority) {
+        return {*this, priority, true};
+    }
+
+    // То же, но продолжение всегда уходит в общую очередь: воркер успевает взять другие задачи уровня, а корутина
+    // может продолжиться на другом воркере.
+    ScheduleAwaiter Yield(TaskPriority priority) {
+        return {*this, priority, false};
+    }
+
+    // Запускает корутину на воркере с приоритетом priority и возвращает Future с ее результатом.
+    template<typename T>
+    Future<T> Spawn(TaskPriority priority, coro::Task<T> task) {
+        return coro::Start(RunOn(priority, std::move(task)));
+    }
+
+    // Вызывает fn для каждого элемента range, распределяя итерации по воркерам с приоритетом priority (см.
+    // detail::ParallelCursor). grain - наименьшее число итераций, которое имеет смысл отдавать отдельной задаче.
+    // Вызывающий поток выполняет итерации сам, а не ждет, поэтому вызов допустим и из задачи воркера.
+    template<std::ranges::random_access_range Range, typename F>
+        requires(std::ranges::sized_range<Range> && std::invocable<F&, std::ranges::range_reference_t<Range>>)
+    void ParallelFor(Range&& range, size_t grain, F&& fn, TaskPriority priority = TaskPriority::Normal) {
+        class Body final: public detail::ParallelBody {
+            public:
+            Body(Range& range, F& fn): range_(range), fn_(fn) {}
+
+            void Segment(detail::ParallelCursor& cursor) override {
+                const auto first = std::ranges::begin(range_);
+                for(size_t begin, end; cursor.Next(begin, end);) {
+                    for(size_t i = begin; i < end; ++i) {
+                        std::invoke(fn_, first[static_cast<std::ranges::range_difference_t<Range>>(i)]);
+                    }
+                }
+            }
+
+            private:
+            Range& range_;
+            F& fn_;
+        };
+
+        Body body(range, fn);
+        RunParallel(static_cast<size_t>(std::ranges::size(range)), grain, priority, body);
+    }
+
+    // Параллельный std::transform_reduce: reduce(init, transform(x) для всех x из range). Итерации распределяются, как
+    // в ParallelFor(); каждый участок сворачивает свои элементы сам, а результаты участков сворачиваются в
+    // произвольном порядке, поэтому reduce должна быть ассоциативной и коммутативной.
+    template<std::ranges::random_access_range Range, typename T, typename Reduce, typename Transform = std::identity>
+        requires(std::ranges::sized_range<Range> &&
+                 std::invocable<Transform&, std::ranges::range_reference_t<Range>>)
+    T ParallelReduce(Range&& range, size_t grain, T init, Reduce reduce, Transform transform = {},
+                     TaskPriority priority = TaskPriority::Normal) {
+        class Body final: public detail::ParallelBody {
+            public:
+            Body(Range& range, Reduce& reduce, Transform& transform):
+                range_(range),
+                reduce_(reduce),
+                transform_(transform) {}
+
+            void Segment(detail::ParallelCursor& cursor) override {
+                const auto first = std::ranges::begin(range_);
+                std::optional<T> partial;  // Нейтрального элемента у reduce нет: участок начинается с первого элемента.
+                for(size_t begin, end; cursor.Next(begin, end);) {
+                    for(size_t i = begin; i < end; ++i) {
+                        T value = std::invoke(transform_, first[static_cast<Difference>(i)]);
+                        Fold(partial, std::move(value));
+                    }
+                }
+                if(partial) {
+                    std::lock_guard lock(mutex_);  // Один раз на участок.
+                    Fold(total_, std::move(*partial));
+                }
+            }
+
+            std::optional<T> Take() {
+                return std::move(total_);
+            }
+
+            private:
+            using Difference = std::ranges::range_difference_t<Range>;
+
+            void Fold(std::optional<T>& into, T value) {
+                if(into) {
+                    into = std::invoke(reduce_, std::move(*into), std::move(value));
+                }
+                else {
+                    into.emplace(std::move(value));
+                }
+            }
+
+            Range& range_;
+            Reduce& reduce_;
+            Transform& transform_;
+            std::mutex mutex_;
+            std::optional<T> total_;
+        };
+
+        Body body(range, reduce, transform);
+        RunParallel(static_cast<size_t>(std::ranges::size(range)), grain, priority, body);
+        if(auto total = body.Take()) {
+            return std::invoke(reduce, std::move(init), std::move(*total));
+        }
+        return init;
+    }
+
+    // Последовательный исполнитель на уровне priority (см. strand.hpp): его задачи выполняются по одной в порядке
+    // постановки, не блокируя воркеров. Уровень с политикой DropOldest отклоняется (std::invalid_argument).
+    Strand MakeStrand(TaskPriority priority);
+
+    // Планирует пачку задач одного приоритета (см. PriorityQueue::PushBatch()). Задачи из tasks перемещаются.
+    void ScheduleBulk(TaskPriority priority, std::span<Task> tasks);
 
-    void Schedule(TaskPriority priority, std::function<void()> task);
+    // Перегрузка для произвольного диапазона вызываемых объектов: они собираются в непрерывную пачку задач.
+    template<std::ranges::input_range Range>
+        requires(!std::convertible_to<Range, std::span<Task>> &&
+                 std::constructible_from<Task, std::ranges::range_reference_t<Range>>)
+    void ScheduleBulk(TaskPriority priority, Range&& tasks) {
+        std::vector<Task> batch;
+        if constexpr(std::ranges::sized_range<Range>) {
+            batch.reserve(std::ranges::size(tasks));
+        }
+        for(auto&& task: tasks) {
+            batch.emplace_back(std::forward<decltype(task)>(task));
+        }
+        ScheduleBulk(priority, std::span<Task>(batch));
+    }
 };
 
 }  // namespace dispatcher
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include "future.hpp"
+#include "task.hpp"
+#include "task_dispatcher.hpp"
+#include "types.hpp"
+
+namespace dispatcher {
+
+class ExecutableGraph;
+
+// Построитель графа зависимостей: узлы - задачи со своим приоритетом, ребро before -> after значит, что after
+// начнется только после завершения before. Граф строится один раз и превращается в ExecutableGraph, который можно
+// запускать сколько угодно раз.
+class TaskGraph {
+    public:
+    using NodeId = uint32_t;
+
+    NodeId AddNode(TaskPriority priority, Task work);
+
+    void AddEdge(NodeId before, NodeId after);
+
+    size_t Size() const {
+        return nodes_.size();
+    }
+
+    // Проверяет, что в графе нет циклов, и замораживает его. После вызова построитель пуст.
+    ExecutableGraph Instantiate();
+
+    private:
+    struct Node {
+        TaskPriority priority;
+        Task work;
+        std::vector<NodeId> successors;
+    };
+
+    std::vector<Node> nodes_;
+};
+
+// Готовый к запуску граф. Структура графа неизменна и общая для всех запусков, а у каждого запуска свои счетчики
+// незавершенных предшественников: узел планируется в TaskDispatcher в тот момент, когда завершается последний из них,
+// без внешней координации и повторного обхода графа. Запуски могут пересекаться во времени - тогда задачи узлов
+// вызываются параллельно из разных запусков и должны это допускать.
+class ExecutableGraph {
+    struct Plan {
+        std::vector<TaskPriority> priorities;
+        std::vector<Task> work;
+        std::vector<uint32_t> offsets;  // Последователи узла i - successors[offsets[i], offsets[i + 1]).
+        std::vector<uint32_t> successors;
+        std::vector<uint32_t> in_degree;
+        std::vector<uint32_t> roots;  // Узлы без предшественников.
+    };
+
+    // Состояние одного запуска. Живет, пока не завершится последний узел, и удаляется им же.
+    struct Execution {
+        std::shared_ptr<Plan> plan;
+        TaskDispatcher* dispatcher = nullptr;
+        std::unique_ptr<std::atomic<uint32_t>[]> pending;  // Сколько предшественников узла еще не завершились.
+        std::atomic<size_t> remaining {0};                  // Сколько узлов еще не завершились.
+        std::atomic<bool> failed {false};
+        std::exception_ptr error;  // Первое исключение; пишет тот, кто выставил failed.
+        Promise<void> promise;
+    };
+
+    std::shared_ptr<Plan> plan_;
+
+    explicit ExecutableGraph(std::shared_ptr<Plan> plan): plan_(std::move(plan)) {}
+
+    friend class TaskGraph;
+
+    static void Submit(Execution* execution, uint32_t node);
+
+    static void Execute(Execution* execution, uint32_t node);
+
+    // Отпускает последователей завершенного узла и завершает запуск после последнего узла.
+    static void Finish(Execution* execution, uint32_t node);
+
+    static void Fail(Execution* execution, std::exception_ptr error);
+
+    public:
+    ExecutableGraph() = default;
+
+    size_t Size() const {
+        return plan_ ? plan_->work.size() : 0;
+    }
+
+    // Запускает граф на dispatcher. Future готов, когда завершены все узлы. Если задача узла выбросила исключение,
+    // задачи еще не начатых узлов пропускаются, а Future получает первое исключение. Узел, отклоненный политикой
+    // Reject, считается упавшим; вытеснения политикой DropOldest граф не переживает - для его уровней ее лучше не
+    // использовать. Если приоритет какого-то узла не настроен в dispatcher, бросает std::invalid_argument, не запуская
+    // ни одного узла.
+    Future<void> Run(TaskDispatcher& dispatcher) const;
+};
+
+}  // namespace dispatcher
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "task.hpp"
+#include "task_dispatcher.hpp"
+#include "types.hpp"
+
+namespace dispatcher {
+
+// Группа задач fork-join: Run() планирует задачу в группе, Wait() ждет завершения всех задач группы. На воркере Wait()
+// не простаивает, а выполняет готовые задачи диспетчера, начиная с высшего приоритета (см.
+// ThreadPool::RunPending()), и засыпает вместе с простаивающими воркерами, только когда выполнять нечего (см.
+// PriorityQueue::SleepWhile()): его будит и новая задача, и завершение группы. Поэтому задача может ждать свои
+// подзадачи даже в пуле из одного воркера: он выполнит их сам. Задачи, запланированные в группе изнутри воркера в
+// режиме work-stealing, остаются в его локальной очереди и обычно выполняются им же в Wait(), без обращения к общей
+// очереди.
+class TaskGroup {
+    public:
+    explicit TaskGroup(TaskDispatcher& dispatcher): dispatcher_(dispatcher) {}
+
+    TaskGroup(const TaskGroup&)            = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Дожидается задач группы; исключение при этом теряется, поэтому Wait() лучше вызывать явно.
+    ~TaskGroup();
+
+    // Планирует задачу в группе (см. TaskDispatcher::Schedule()). Если политика Reject отклонила задачу, бросает
+    // std::runtime_error, для ненастроенного уровня - std::invalid_argument; в обоих случаях группа задачу не ждет.
+    // Вытесненную политикой DropOldest задачу группа ждала бы вечно - для уровней групп эту политику лучше не
+    // использовать. Обертка группы хранит f напрямую, поэтому небольшой f остается во встроенном буфере Task; уже
+    // готовый Task в ней не помещается и стоит аллокации.
+    template<typename F>
+        requires std::invocable<std::decay_t<F>&>
+    void Run(TaskPriority priority, F&& f) {
+        Post(priority, [this, f = std::forward<F>(f)]() mutable {
+            try {
+                f();
+            }
+            catch(...) {
+                Fail(std::current_exception());
+            }
+            Finish();
+        });
+    }
+
+    // Ждет завершения всех задач группы, включая запланированные во время ожидания, и пробрасывает первое исключение
+    // из них. После Wait() группу можно использовать снова.
+    void Wait();
+
+    private:
+    // Учитывает и планирует обертку задачи; если она не поставлена, откатывает учет и бросает исключение.
+    void Post(TaskPriority priority, Task job);
+
+    // Запоминает исключение задачи, если оно первое.
+    void Fail(std::exception_ptr error);
+
+    void Finish();
+
+    TaskDispatcher& dispatcher_;
+    std::atomic<size_t> pending_ {0};
+
+    // Задача уменьшает pending_ под mutex_: ожидающий, увидев ноль, захватывает mutex_ и этим дожидается, пока
+    // завершившая задача перестанет обращаться к группе, прежде чем ее разрушат.
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::exception_ptr error_;  // Первое исключение задач группы. Под mutex_.
+};
+
+}  // namespace dispatcher
@@ -1,28 +1,156 @@
 #pragma once
 
 #include "queue/priority_queue.hpp"
+#include "thread_pool/topology.hpp"
+#include "thread_pool/work_stealing_deque.hpp"
+#include "types.hpp"
 
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <optional>
 #include <mutex>
 #include <condition_variable>
+#include <list>
 #include <memory>
+#include <stop_token>
 #include <vector>
 
 namespace dispatcher::thread_pool {
 
+// Привязка воркеров к процессорам (см. CpuTopology). Воркеры раскладываются по узлам NUMA по кругу: i-й воркер
+// попадает на узел i % число_узлов.
+enum class Placement {
+    None,  // Потоками распоряжается планировщик ОС.
+    Cpu,   // Каждый воркер привязан к одному CPU своего узла; CPU узла раздаются по кругу.
+    Node,  // Воркер привязан ко всем CPU своего узла и может мигрировать только внутри него.
+};
+
+struct ThreadPoolOptions {
+    // Каждый воркер получает локальные очереди (по одной на приоритет). Задачи, запланированные изнутри воркера,
+    // кладутся в его локальную очередь, а простаивающие воркеры воруют задачи у соседей. Уровни перебираются строго по
+    // приоритету: веса и старение из QueueOptions в этом режиме не учитываются.
+    bool work_stealing {false};
+
+    // Сколько задач воркер забирает из PriorityQueue за один захват мьютекса (см. PriorityQueue::PopBatch()) и
+    // выполняет локально. Между задачами пачки воркер сперва выполняет появившиеся задачи более высокого приоритета.
+    // Действует только без work-stealing; 1 - забирать задачи по одной.
+    size_t pop_batch {1};
+
+    // Как воркер ждет задачу, когда очередь пуста: сколько крутиться и уступать процессор, прежде чем уснуть (см.
+    // queue::SpinWait). Вращение экономит засыпание и пробуждение на частых коротких задачах, но занимает ядро;
+    // по умолчанию воркер засыпает сразу. Разумная отправная точка для задач в единицы микросекунд - {4096, 16}.
+    queue::SpinOptions spin {};
+
+    // Эластичный размер пула. num_threads из конструктора - минимальное и начальное число воркеров. Если max_threads
+    // больше него, поток-надзиратель раз в scale_interval смотрит на очередь: добавляет воркера, когда в очередях
+    // дольше spawn_delay лежит больше spawn_depth задач и при этом нет спящих воркеров, и отпускает по одному лишнему
+    // воркеру, пока спящие воркеры и пустые очереди держатся дольше idle_timeout. Решения принимает только
+    // надзиратель, поэтому ни Pop(), ни цикл воркера за масштабирование не платят. Только без work-stealing.
+    size_t max_threads {0};
+    size_t spawn_depth {0};
+    std::chrono::milliseconds spawn_delay {10};
+    std::chrono::milliseconds idle_timeout {1000};
+    std::chrono::milliseconds scale_interval {5};
+
+    // Привязка воркеров к CPU и узлам NUMA. В режиме work-stealing воркер ворует сперва у соседей по узлу и только
+    // потом, если на его узле работы нет, - у воркеров других узлов. Если привязка не удалась (нет прав, CPU вне
+    // cgroup), воркер просто работает без нее.
+    Placement placement {Placement::None};
+};
+
 class ThreadPool {
+    struct Worker {
+        ThreadPool* pool = nullptr;
+        size_t index     = 0;
+        std::vector<std::unique_ptr<WorkStealingDeque>> local;  // Индекс - значение TaskPriority.
+        std::vector<Worker*> victims;                           // Сперва соседи по узлу, затем воркеры других узлов.
+        size_t near = 0;                                        // Сколько первых victims - соседи по узлу.
+    };
+
     std::shared_ptr<queue::PriorityQueue> pq_ = nullptr;
-    std::vector<std::jthread> workers_ {};
+    ThreadPoolOptions options_ {};
+    std::vector<TaskPriority> priorities_ {};  // Приоритеты очереди от высшего к низшему.
+    std::vector<std::unique_ptr<Worker>> states_ {};
+    std::atomic<size_t> idle_ {0};  // Сколько воркеров режима work-stealing припарковано в PriorityQueue::Pop().
+    std::vector<std::vector<int>> nodes_ {};  // CPU узлов NUMA для привязки воркеров; пусто - без привязки.
+    size_t spawned_ = 0;                      // Сколько воркеров запущено за все время: номер следующего в раскладке.
+
+    struct Thread {
+        std::jthread thread;
+        std::atomic<bool> finished {false};  // Воркер вышел из цикла, поток можно присоединить.
+    };
+
+    // После конструктора список меняет только надзиратель, а после его остановки - деструктор.
+    std::list<Thread> workers_ {};
+    std::atomic<size_t> thread_count_ {0};      // Воркеры, еще не вышедшие из цикла.
+    std::atomic<bool> retire_pending_ {false};  // В очереди лежит задача-отставка (см. Supervise()).
+
+    std::mutex supervisor_mutex_;
+    std::condition_variable_any supervisor_cv_;
+    std::jthread supervisor_ {};
+
+    static thread_local Worker* current_worker_;    // Воркер текущего потока или nullptr.
+    static thread_local ThreadPool* current_pool_;  // Пул, которому принадлежит текущий поток, или nullptr.
+    static thread_local bool retire_;               // Текущему воркеру велено выйти после текущей задачи.
 
     public:
-    ThreadPool(std::shared_ptr<queue::PriorityQueue> pq, size_t num_threads = std::thread::hardware_concurrency());
+    ThreadPool(std::shared_ptr<queue::PriorityQueue> pq, size_t num_threads = std::thread::hardware_concurrency(),
+               ThreadPoolOptions options = {});
+
+    // Кладет задачу в локальную очередь текущего воркера, если вызвана из воркера этого пула в режиме work-stealing.
+    // Возвращает false (задача не тронута), если задачу нужно отправить в общую PriorityQueue.
+    bool TryPushLocal(TaskPriority priority, Task& task);
+
+    // Выполняет одну готовую задачу, если вызвана из воркера этого пула: берет ее так же, как воркер, - от высшего
+    // приоритета к низшему, в режиме work-stealing и из локальных очередей. Не блокируется. Возвращает false, если
+    // выполнять нечего или поток не воркер пула.
+    bool RunPending();
+
+    // Засыпает как простаивающий воркер, пока выполнять нечего и pending не ноль (см. PriorityQueue::SleepWhile()).
+    // Вызывается из воркера этого пула, когда RunPending() вернула false.
+    void SleepWhile(const std::atomic<size_t>& pending);
+
+    // Текущий поток - воркер этого пула.
+    bool OnWorker() const {
+        return current_pool_ == this;
+    }
+
+    // Сколько воркеров сейчас в пуле.
+    size_t ThreadCount() const {
+        return thread_count_.load(std::memory_order_relaxed);
+    }
 
     ~ThreadPool();
 
     private:
+    // Запускает воркера. state - состояние воркера режима work-stealing.
+    void Spawn(Worker* state = nullptr);
+
+    // Узел NUMA воркера с порядковым номером index.
+    size_t NodeOf(size_t index) const;
+
+    // CPU, к которым привязывается воркер с порядковым номером index (см. ThreadPoolOptions::placement).
+    std::vector<int> CpusOf(size_t index) const;
+
+    // Цикл надзирателя эластичного пула: добавляет и отпускает воркеров (см. ThreadPoolOptions::max_threads).
+    void Supervise(std::stop_token stop, size_t min_threads);
+
+    // Присоединяет потоки вышедших воркеров.
+    void Reap();
+
     void Run();
+
+    void RunBatched();
+
+    // Выполняет задачи из очередей приоритета выше priority, пока они есть.
+    void RunHigher(TaskPriority priority);
+
+    void RunStealing(Worker& self);
+
+    std::optional<Task> FindTask(Worker& self);
+
+    static void Execute(Task& task);
 };
 
 }  // namespace dispatcher::thread_pool
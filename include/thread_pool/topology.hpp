@@ -0,0 +1,24 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace dispatcher::thread_pool {
+
+// Раскладка доступных процессу CPU по узлам NUMA. Узлы читаются из /sys/devices/system/node без libnuma; CPU, не
+// входящие в маску привязки процесса, отбрасываются, а узлы без доступных CPU пропускаются. Если /sys недоступен (не
+// Linux, контейнер без sysfs), все доступные CPU считаются одним узлом.
+struct CpuTopology {
+    std::vector<std::vector<int>> nodes;  // Номера CPU каждого узла по возрастанию. Хотя бы один непустой узел.
+
+    static CpuTopology Discover();
+
+    // Разбирает список CPU в формате ядра: "0-3,8,10-11". Пробелы и перевод строки по краям игнорируются.
+    static std::vector<int> ParseCpuList(std::string_view list);
+};
+
+// Привязывает текущий поток к набору CPU. Возвращает false, если привязка не удалась или не поддерживается платформой.
+bool PinCurrentThread(std::span<const int> cpus);
+
+}  // namespace dispatcher::thread_pool
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "task.hpp"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace dispatcher::thread_pool {
+
+// Локальная очередь воркера для режима work-stealing. Владелец кладет и забирает задачи с "низа" (LIFO - горячий кэш),
+// воры забирают самые старые задачи с "верха". Мьютекс почти всегда свободен: его делят только владелец и изредка
+// простаивающие воры, а пустые очереди отсекаются по атомарному размеру без захвата мьютекса.
+class WorkStealingDeque {
+    std::mutex mutex_;
+    std::deque<Task> tasks_;
+    std::atomic<size_t> size_ {0};
+
+    public:
+    WorkStealingDeque() = default;
+
+    void PushBottom(Task task);
+
+    std::optional<Task> PopBottom();
+
+    std::optional<Task> Steal();
+
+    bool Empty() const {
+        return size_.load(std::memory_order_acquire) == 0;
+    }
+};
+
+}  // namespace dispatcher::thread_pool
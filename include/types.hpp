@@ -1,9 +1,23 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 namespace dispatcher {
 
-enum class TaskPriority { High, Normal };
+// Уровень приоритета: чем меньше значение, тем выше приоритет. Допустимо любое значение из [0, kMaxPriorityLevels),
+// High и Normal - именованные первые два уровня.
+enum class TaskPriority : uint8_t { High = 0, Normal = 1 };
 
-}  // namespace dispatcher
\ No newline at end of file
+// Сколько уровней приоритета поддерживает PriorityQueue: непустые уровни хранятся битами в одном uint64_t.
+inline constexpr std::size_t kMaxPriorityLevels = 64;
+
+constexpr TaskPriority PriorityLevel(std::size_t level) {
+    return static_cast<TaskPriority>(level);
+}
+
+// Размер кэш-линии, по которому выравниваются разделяемые между ядрами данные.
+inline constexpr std::size_t kCacheLineSize = 64;
+
+}  // namespace dispatcher
@@ -8,6 +8,8 @@
 using namespace dispatcher;
 
 int main() {
+    // Воркеры только дописывают сообщения в свои буферы, а в stdout их пачками пишет фоновый поток логгера.
+    Logger::Configure({.async = true});
 
     std::println("Task dispatcher started.\n");
     {
@@ -21,9 +23,9 @@ int main() {
             threads.emplace_back([&, i]() {
                 for(int j = 0; j < 10; j++) {
                     td.Schedule(TaskPriority::Normal,
-                                [=]() { Logger::Get().Log("Normal priority message #" + std::to_string(10 * i + j)); });
+                                [=]() { Logger::Get().Log("Normal priority message #{}", 10 * i + j); });
                     td.Schedule(TaskPriority::High,
-                                [=]() { Logger::Get().Log("High priority message #" + std::to_string(10 * i + j)); });
+                                [=]() { Logger::Get().Log("High priority message #{}", 10 * i + j); });
                 }
             });
         }
@@ -31,6 +33,7 @@ int main() {
         // Последним при расрутки стека вызовется деструктор TaskDispatcher. Воркеры сделают все работу и корректно
         // освободят ресурсы.
     }
+    Logger::Get().Flush();
 
     std::println("\nTask dispatcher completed.");
 }
@@ -0,0 +1,230 @@
+#include "logger.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Пишет куски подряд. writev() может записать только часть: тогда дописываем остаток.
+void WriteChunks(FILE* file, std::span<const std::string_view> chunks) {
+    // То, что успели написать в файл через stdio (например, std::println), должно оказаться раньше сообщений.
+    fflush(file);
+#ifdef __linux__
+    std::vector<iovec> vectors;
+    vectors.reserve(chunks.size());
+    for(auto chunk: chunks) {
+        if(!chunk.empty()) {
+            vectors.push_back({const_cast<char*>(chunk.data()), chunk.size()});
+        }
+    }
+    const int fd = fileno(file);
+    size_t done  = 0;
+    while(done < vectors.size()) {
+        const auto count    = static_cast<int>(std::min<size_t>(vectors.size() - done, IOV_MAX));
+        const ssize_t wrote = writev(fd, vectors.data() + done, count);
+        if(wrote < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return;  // Писать некуда: сообщения теряются, как потерялись бы и у fprintf().
+        }
+        auto left = static_cast<size_t>(wrote);
+        while(done < vectors.size() && left >= vectors[done].iov_len) {
+            left -= vectors[done].iov_len;
+            ++done;
+        }
+        if(left > 0) {
+            vectors[done].iov_base = static_cast<char*>(vectors[done].iov_base) + left;
+            vectors[done].iov_len -= left;
+        }
+    }
+#else
+    for(auto chunk: chunks) {
+        fwrite(chunk.data(), 1, chunk.size(), file);
+    }
+    fflush(file);
+#endif
+}
+
+}  // namespace
+
+Logger::Logger(FILE* file, LoggerOptions options):
+    file_(file),
+    async_(options.async),
+    capacity_(std::bit_ceil(options.buffer_size)),
+    flush_interval_(options.flush_interval) {
+    if(options.buffer_size == 0) {
+        throw std::invalid_argument("Logger buffer size must be positive");
+    }
+    if(!async_) {
+        // отключаем буферизацию
+        setvbuf(file_, nullptr, _IONBF, 0);
+        return;
+    }
+    flusher_ = std::jthread([this](std::stop_token stop) { RunFlusher(stop); });
+}
+
+Logger::~Logger() {
+    if(flusher_.joinable()) {
+        flusher_.request_stop();
+        flusher_.join();
+    }
+    if(async_) {
+        Drain();
+    }
+}
+
+void Logger::Log(std::string_view message) {
+    if(async_) {
+        Append(message);
+        return;
+    }
+    // Одна запись на сообщение вместе с переводом строки: строки разных потоков не перемешиваются.
+    fprintf(file_, "%.*s\n", static_cast<int>(message.size()), message.data());
+}
+
+void Logger::Flush() {
+    if(async_) {
+        Drain();
+    }
+    else {
+        fflush(file_);
+    }
+}
+
+Logger::Buffer& Logger::Local() {
+    struct Cache {
+        uint64_t owner = 0;
+        std::shared_ptr<Buffer> buffer;
+
+        ~Cache() {
+            if(buffer) {
+                buffer->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+    thread_local Cache cache;
+    if(cache.owner == id_) {
+        return *cache.buffer;
+    }
+
+    const auto thread = std::this_thread::get_id();
+    std::lock_guard lock(buffers_mutex_);
+    // Поток мог уже писать в этот логгер, а потом переключиться на другой. Иначе берем буфер завершившегося потока: его
+    // непрочитанные сообщения уйдут раньше новых, порядок не нарушится.
+    auto it = std::ranges::find_if(buffers_, [thread](const auto& buffer) {
+        return buffer->owner == thread && buffer->owned.load(std::memory_order_acquire);
+    });
+    if(it == buffers_.end()) {
+        it = std::ranges::find_if(buffers_,
+                                  [](const auto& buffer) { return !buffer->owned.load(std::memory_order_acquire); });
+    }
+    if(it == buffers_.end()) {
+        it = buffers_.insert(buffers_.end(), std::make_shared<Buffer>(capacity_));
+    }
+    (*it)->owner = thread;
+    (*it)->owned.store(true, std::memory_order_relaxed);
+    // Не через временный Cache: его деструктор освободил бы буфер.
+    cache.owner  = id_;
+    cache.buffer = *it;
+    return **it;
+}
+
+void Logger::Append(std::string_view message) {
+    const size_t size = message.size() + 1;
+    if(size > capacity_) {
+        // Сообщение не помещается даже в пустой буфер: сбрасываем накопленное и пишем его напрямую.
+        std::lock_guard lock(drain_mutex_);
+        DrainLocked();
+        const std::string_view chunks[] = {message, "\n"};
+        WriteChunks(file_, chunks);
+        return;
+    }
+
+    auto& buffer        = Local();
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    uint64_t tail       = buffer.tail.load(std::memory_order_acquire);
+    for(int yields = 0; head + size - tail > capacity_; ++yields) {
+        if(yields < kFullBufferYields && !flusher_.get_stop_token().stop_requested()) {
+            // Буфер полон: будим фоновый поток и ждем, пока он освободит место.
+            flusher_cv_.notify_one();
+            std::this_thread::yield();
+        }
+        else {
+            // Фоновый поток остановлен или застрял в медленной записи: сбрасываем сами. Под drain_mutex_ поток не
+            // крутится, а ждет окончания текущего сброса.
+            Drain();
+        }
+        tail = buffer.tail.load(std::memory_order_acquire);
+    }
+
+    const size_t start = head & buffer.mask;
+    const size_t first = std::min(message.size(), capacity_ - start);
+    std::memcpy(buffer.data.get() + start, message.data(), first);
+    std::memcpy(buffer.data.get(), message.data() + first, message.size() - first);
+    buffer.data[(head + message.size()) & buffer.mask] = '\n';
+    buffer.head.store(head + size, std::memory_order_release);
+
+    // Будим фоновый поток, только когда буфер переваливает за половину: на остальных сообщениях он проснется сам.
+    const uint64_t half = capacity_ / 2;
+    if(head - tail < half && head + size - tail >= half) {
+        flusher_cv_.notify_one();
+    }
+}
+
+void Logger::Drain() {
+    std::lock_guard lock(drain_mutex_);
+    DrainLocked();
+}
+
+void Logger::DrainLocked() {
+    {
+        std::lock_guard lock(buffers_mutex_);
+        draining_.assign(buffers_.begin(), buffers_.end());
+    }
+    chunks_.clear();
+    heads_.clear();
+    for(const auto& buffer: draining_) {
+        // Читатель один (под drain_mutex_), поэтому свою позицию он читает без синхронизации.
+        const uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        heads_.push_back(head);
+        if(head == tail) {
+            continue;
+        }
+        const size_t start = tail & buffer->mask;
+        const size_t size  = head - tail;
+        const size_t first = std::min(size, capacity_ - start);
+        chunks_.emplace_back(buffer->data.get() + start, first);
+        if(first < size) {
+            chunks_.emplace_back(buffer->data.get(), size - first);
+        }
+    }
+    if(!chunks_.empty()) {
+        WriteChunks(file_, chunks_);
+    }
+    for(size_t i = 0; i < draining_.size(); ++i) {
+        draining_[i]->tail.store(heads_[i], std::memory_order_release);
+    }
+    draining_.clear();
+}
+
+void Logger::RunFlusher(std::stop_token stop) {
+    std::unique_lock lock(flusher_mutex_);
+    while(!stop.stop_requested()) {
+        flusher_cv_.wait_for(lock, stop, flush_interval_, [] { return false; });
+        lock.unlock();
+        Drain();
+        lock.lock();
+    }
+}
@@ -0,0 +1,67 @@
+#include "metrics/histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace dispatcher::metrics {
+
+size_t LatencyHistogram::BucketIndex(uint64_t value) {
+    if(value < kSubBuckets) {
+        return static_cast<size_t>(value);  // Малые значения точны: по корзине на значение.
+    }
+    const auto exponent = static_cast<size_t>(std::bit_width(value)) - 1;  // >= kSubBucketBits.
+    const auto sub      = static_cast<size_t>(value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(size_t index) {
+    if(index < kSubBuckets) {
+        return index;
+    }
+    const size_t exponent = index / kSubBuckets + kSubBucketBits - 1;
+    const uint64_t sub    = index % kSubBuckets;
+    return (kSubBuckets + sub) << (exponent - kSubBucketBits);
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    Bump(buckets_[BucketIndex(value)], 1);
+    Bump(count_, 1);
+    Bump(sum_, value);
+    if(value > max_.load(std::memory_order_relaxed)) {
+        max_.store(value, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::AddTo(HistogramSnapshot& snapshot) const {
+    for(size_t i = 0; i < kBuckets; ++i) {
+        snapshot.buckets[i] += buckets_[i].load(std::memory_order_relaxed);
+    }
+    snapshot.count += count_.load(std::memory_order_relaxed);
+    snapshot.sum += sum_.load(std::memory_order_relaxed);
+    snapshot.max = std::max(snapshot.max, max_.load(std::memory_order_relaxed));
+}
+
+uint64_t HistogramSnapshot::Percentile(double q) const {
+    // Счетчики корзин и count читаются без общей синхронизации, поэтому ранг считаем по сумме корзин.
+    uint64_t total = 0;
+    for(auto bucket: buckets) {
+        total += bucket;
+    }
+    if(total == 0) {
+        return 0;
+    }
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total)));
+
+    uint64_t seen = 0;
+    for(size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if(seen >= rank) {
+            const uint64_t upper = i + 1 < buckets.size() ? LatencyHistogram::BucketLowerBound(i + 1) - 1 : UINT64_MAX;
+            return std::min(upper, max);
+        }
+    }
+    return max;
+}
+
+}  // namespace dispatcher::metrics
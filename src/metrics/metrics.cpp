@@ -0,0 +1,129 @@
+#include "metrics/metrics.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace dispatcher::metrics {
+
+namespace {
+
+std::atomic<uint64_t> next_id {1};
+
+size_t StripeIndex(size_t stripes) {
+    thread_local const size_t index = std::hash<std::thread::id> {}(std::this_thread::get_id());
+    return index % stripes;
+}
+
+}  // namespace
+
+Metrics::Metrics(std::span<const TaskPriority> priorities):
+    id_(next_id.fetch_add(1, std::memory_order_relaxed)),
+    priorities_(priorities.begin(), priorities.end()) {
+    std::ranges::sort(priorities_);
+}
+
+Metrics::ThreadStats& Metrics::Local() {
+    struct Cache {
+        uint64_t owner     = 0;
+        ThreadStats* stats = nullptr;
+    };
+    thread_local Cache cache;
+    if(cache.owner == id_) {
+        return *cache.stats;
+    }
+
+    // Первая задача этого экземпляра на потоке: находим или регистрируем статистику потока. Дальше - только кэш.
+    std::lock_guard lock(mutex_);
+    const auto self = std::this_thread::get_id();
+    auto it         = std::ranges::find_if(threads_, [&](const auto& stats) { return stats->thread == self; });
+    if(it == threads_.end()) {
+        auto stats    = std::make_unique<ThreadStats>();
+        stats->thread = self;
+        for(auto priority: priorities_) {
+            stats->levels[static_cast<size_t>(priority)] = std::make_unique<LevelStats>();
+        }
+        threads_.push_back(std::move(stats));
+        it = std::prev(threads_.end());
+    }
+    cache = {id_, it->get()};
+    return *cache.stats;
+}
+
+Task Metrics::Instrument(TaskPriority priority, Task task) {
+    if(const auto level = static_cast<size_t>(priority); level < kMaxPriorityLevels) {
+        // Полосу делят несколько потоков, поэтому здесь нужен RMW, но на одну кэш-линию приходится мало писателей.
+        stripes_[StripeIndex(kStripes)].enqueued[level].fetch_add(1, std::memory_order_relaxed);
+    }
+    return [this, priority, enqueued = Clock::now(), task = std::move(task)]() mutable { Run(priority, enqueued, task); };
+}
+
+void Metrics::Discard(TaskPriority priority, uint64_t count) {
+    if(const auto level = static_cast<size_t>(priority); level < kMaxPriorityLevels) {
+        stripes_[StripeIndex(kStripes)].discarded[level].fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::Run(TaskPriority priority, Clock::time_point enqueued, Task& task) {
+    auto& stats      = Local();
+    auto* level      = stats.levels[static_cast<size_t>(priority)].get();
+    const auto start = Clock::now();
+    auto finish      = [&](bool ok) {
+        const auto run_ns = static_cast<uint64_t>((Clock::now() - start).count());
+        Bump(stats.executed, 1);
+        Bump(stats.busy_ns, run_ns);
+        if(level) {
+            level->run.Record(run_ns);
+            Bump(ok ? level->completed : level->failed, 1);
+        }
+    };
+
+    if(level) {
+        level->wait.Record(static_cast<uint64_t>(std::max(Clock::duration::zero(), start - enqueued).count()));
+        Bump(level->started, 1);
+    }
+    try {
+        task();
+    }
+    catch(...) {
+        finish(false);
+        throw;  // Исключение по-прежнему обрабатывает воркер.
+    }
+    finish(true);
+}
+
+Snapshot Metrics::Collect() {
+    Snapshot snapshot;
+    snapshot.levels.reserve(priorities_.size());
+    for(auto priority: priorities_) {
+        const auto level = static_cast<size_t>(priority);
+        auto& out        = snapshot.levels.emplace_back();
+        out.priority     = priority;
+        for(const auto& stripe: stripes_) {
+            out.enqueued += stripe.enqueued[level].load(std::memory_order_relaxed);
+            out.discarded += stripe.discarded[level].load(std::memory_order_relaxed);
+        }
+    }
+
+    std::lock_guard lock(mutex_);
+    snapshot.workers.reserve(threads_.size());
+    for(const auto& stats: threads_) {
+        snapshot.workers.push_back({stats->thread, stats->executed.load(std::memory_order_relaxed),
+                                    std::chrono::nanoseconds(stats->busy_ns.load(std::memory_order_relaxed))});
+        for(auto& out: snapshot.levels) {
+            const auto& level = *stats->levels[static_cast<size_t>(out.priority)];
+            out.started += level.started.load(std::memory_order_relaxed);
+            out.completed += level.completed.load(std::memory_order_relaxed);
+            out.failed += level.failed.load(std::memory_order_relaxed);
+            level.wait.AddTo(out.wait);
+            level.run.AddTo(out.run);
+        }
+    }
+    for(auto& out: snapshot.levels) {
+        // Счетчики читаются не атомарно все вместе, поэтому разность может ненадолго уйти в минус.
+        const uint64_t gone = out.started + out.discarded;
+        out.depth           = out.enqueued > gone ? out.enqueued - gone : 0;
+    }
+    return snapshot;
+}
+
+}  // namespace dispatcher::metrics
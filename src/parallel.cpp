@@ -0,0 +1,157 @@
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include "task_dispatcher.hpp"
+
+namespace dispatcher::detail {
+
+// Общее состояние одного ParallelFor()/ParallelReduce(). Задачи отщепленных участков держат его через shared_ptr:
+// вызывающий поток может вернуться раньше, чем воркеры возьмут задачи участков, которые он забрал себе сам.
+struct ParallelRegion: std::enable_shared_from_this<ParallelRegion> {
+    // Отщепленный участок. Его выполняет тот, кто первым поднимет claimed: воркер, взявший задачу участка, или
+    // вызывающий поток, закончивший свои итерации.
+    struct Slot {
+        size_t begin;
+        size_t end;
+        std::atomic<bool> claimed {false};
+    };
+
+    ParallelRegion(TaskDispatcher& dispatcher, const queue::PriorityQueue& pq, ParallelBody& body, size_t grain,
+                   TaskPriority priority):
+        dispatcher(dispatcher),
+        pq(pq),
+        body(body),
+        grain(grain),
+        priority(priority) {}
+
+    TaskDispatcher& dispatcher;
+    const queue::PriorityQueue& pq;
+    ParallelBody& body;  // Висит после возврата вызывающего, но используется только до него (см. claimed).
+    const size_t grain;
+    const TaskPriority priority;
+
+    std::mutex mutex;  // Защищает slots и scanned. Участки отщепляются редко, поэтому мьютекс не на горячем пути.
+    std::deque<Slot> slots;
+    size_t scanned = 0;  // Участки до scanned уже кем-то забраны.
+
+    std::atomic<size_t> unfinished {1};  // Незавершенные участки, включая участок вызывающего потока.
+    std::atomic<uint32_t> signal {0};    // Меняется, когда отщеплен участок или завершен последний: будит вызывающего.
+
+    std::atomic<bool> failed {false};
+    std::exception_ptr error;  // Первое исключение; пишет тот, кто выставил failed.
+
+    void Notify() {
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+    }
+
+    // Забирает участок, который еще никто не взял, или возвращает nullptr.
+    Slot* Claim() {
+        std::lock_guard lock(mutex);
+        while(scanned < slots.size()) {
+            auto& slot = slots[scanned++];
+            if(!slot.claimed.exchange(true, std::memory_order_acq_rel)) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    void Run(size_t begin, size_t end) {
+        ParallelCursor cursor(*this, begin, end);
+        try {
+            body.Segment(cursor);
+        }
+        catch(...) {
+            if(!failed.exchange(true, std::memory_order_acq_rel)) {
+                error = std::current_exception();
+            }
+        }
+        if(unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Notify();
+        }
+    }
+};
+
+bool ParallelCursor::Next(size_t& begin, size_t& end) {
+    if(begin_ >= end_ || region_.failed.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    // Проверка спроса - одно чтение счетчика задач PriorityQueue на каждые grain итераций.
+    if(end_ - begin_ >= 2 * region_.grain && region_.pq.Available() == 0) {
+        Fork();
+    }
+    begin  = begin_;
+    end    = begin_ + std::min(region_.grain, end_ - begin_);
+    begin_ = end;
+    return true;
+}
+
+void ParallelCursor::Fork() {
+    const size_t middle = begin_ + (end_ - begin_) / 2;
+    // Счетчик растет раньше, чем участок становится доступен: иначе его могли бы забрать и завершить до увеличения, и
+    // вызывающий поток увидел бы ноль незавершенных раньше времени.
+    region_.unfinished.fetch_add(1, std::memory_order_relaxed);
+    ParallelRegion::Slot* slot;
+    {
+        std::lock_guard lock(region_.mutex);
+        slot = &region_.slots.emplace_back(middle, end_);
+    }
+    end_ = middle;
+    region_.Notify();  // Вызывающий поток, ждущий чужие участки, заберет и этот, если воркеры не успеют.
+
+    const bool queued = region_.dispatcher.Admit(
+        region_.priority,
+        [region = region_.shared_from_this(), slot] {
+            if(!slot->claimed.exchange(true, std::memory_order_acq_rel)) {
+                region->Run(slot->begin, slot->end);
+            }
+        },
+        std::chrono::nanoseconds::zero(), false);
+    if(!queued && !slot->claimed.exchange(true, std::memory_order_acq_rel)) {
+        // Уровень не принял задачу: возвращаем половину себе. Ноль незавершенных тут невозможен - наш участок еще идет.
+        end_ = slot->end;
+        region_.unfinished.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace dispatcher::detail
+
+namespace dispatcher {
+
+void TaskDispatcher::RunParallel(size_t size, size_t grain, TaskPriority priority, detail::ParallelBody& body) {
+    if(grain == 0) {
+        throw std::invalid_argument("Parallel loop grain must be positive");
+    }
+    CheckPriority(priority);
+    if(size == 0) {
+        return;
+    }
+
+    auto region = std::make_shared<detail::ParallelRegion>(*this, *pq_, body, grain, priority);
+    region->Run(0, size);
+    while(true) {
+        // signal читаем до поиска участков: участок, отщепленный после поиска, изменит его, и ожидание не уснет.
+        const uint32_t seen = region->signal.load(std::memory_order_acquire);
+        while(auto* slot = region->Claim()) {
+            region->Run(slot->begin, slot->end);
+        }
+        if(region->unfinished.load(std::memory_order_acquire) == 0) {
+            break;
+        }
+        region->signal.wait(seen, std::memory_order_acquire);
+    }
+    if(region->error) {
+        std::rethrow_exception(region->error);
+    }
+}
+
+}  // namespace dispatcher
@@ -2,36 +2,111 @@
 
 namespace dispatcher::queue {
 
-BoundedQueue::BoundedQueue(int capacity): capacity_(capacity) {}
+BoundedQueue::BoundedQueue(int capacity): queue_(capacity > 0 ? static_cast<size_t>(capacity) : 0) {}
 
-void BoundedQueue::Push(std::function<void()> task) {
+void BoundedQueue::Push(Task task) {
     std::unique_lock lock(mutex_);
-    not_full_.wait(lock, [&] { return queue_.size() < capacity_; });
-    queue_.push(std::move(task));
+    not_full_.wait(lock, [&] { return !queue_.Full(); });
+    queue_.Push(std::move(task));
     lock.unlock();
     not_empty_.notify_one();
 }
 
-std::optional<std::function<void()>> BoundedQueue::Pop() {
+bool BoundedQueue::TryPush(Task& task) {
     std::unique_lock lock(mutex_);
-    not_empty_.wait(lock, [&] { return !queue_.empty(); });
-    auto task = std::move(queue_.front());
-    queue_.pop();
+    if(queue_.Full()) {
+        return false;
+    }
+    queue_.Push(std::move(task));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+bool BoundedQueue::PushFor(Task& task, std::chrono::nanoseconds timeout) {
+    std::unique_lock lock(mutex_);
+    if(!not_full_.wait_for(lock, timeout, [&] { return !queue_.Full(); })) {
+        return false;
+    }
+    queue_.Push(std::move(task));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+size_t BoundedQueue::PushDropOldest(Task task) {
+    std::unique_lock lock(mutex_);
+    Task evicted;
+    if(queue_.Full()) {
+        evicted = queue_.Pop();
+    }
+    queue_.Push(std::move(task));
+    lock.unlock();
+    not_empty_.notify_one();
+    return evicted ? 1 : 0;  // Вытесненная задача разрушается уже без мьютекса.
+}
+
+size_t BoundedQueue::PushBatch(std::span<Task> tasks) {
+    if(tasks.empty()) {
+        return 0;
+    }
+    std::unique_lock lock(mutex_);
+    // Ждем не место под всю пачку, а хотя бы один свободный слот: кладем сколько влезло, остальное дозальет вызывающий.
+    not_full_.wait(lock, [&] { return !queue_.Full(); });
+    size_t pushed = 0;
+    while(pushed < tasks.size() && !queue_.Full()) {
+        queue_.Push(std::move(tasks[pushed++]));
+    }
+    lock.unlock();
+    if(pushed == 1) {
+        not_empty_.notify_one();
+    }
+    else {
+        not_empty_.notify_all();
+    }
+    return pushed;
+}
+
+std::optional<Task> BoundedQueue::Pop() {
+    std::unique_lock lock(mutex_);
+    not_empty_.wait(lock, [&] { return !queue_.Empty(); });
+    auto task = queue_.Pop();
     lock.unlock();
     not_full_.notify_one();
     return task;
 }
 
-std::optional<std::function<void()>> BoundedQueue::TryPop() {
+std::optional<Task> BoundedQueue::TryPop() {
     mutex_.lock();
-    if(queue_.empty()) {
+    if(queue_.Empty()) {
         mutex_.unlock();
         return std::nullopt;
     }
-    auto task = std::move(queue_.front());
-    queue_.pop();
+    auto task = queue_.Pop();
     mutex_.unlock();
+    not_full_.notify_one();  // PriorityQueue забирает задачи только через TryPop(), поэтому будим и здесь.
     return task;
 }
 
+size_t BoundedQueue::TryPopBatch(std::span<Task> out) {
+    std::unique_lock lock(mutex_);
+    size_t popped = 0;
+    while(popped < out.size() && !queue_.Empty()) {
+        out[popped++] = queue_.Pop();
+    }
+    lock.unlock();
+    if(popped == 1) {
+        not_full_.notify_one();
+    }
+    else if(popped > 1) {
+        not_full_.notify_all();  // Освободилось несколько слотов - их могут ждать несколько производителей.
+    }
+    return popped;
+}
+
+size_t BoundedQueue::Size() {
+    std::lock_guard lock(mutex_);
+    return queue_.Size();
+}
+
 }  // namespace dispatcher::queue
@@ -0,0 +1,149 @@
+#include "queue/lock_free_queue.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace dispatcher::queue {
+
+LockFreeQueue::LockFreeQueue(int capacity): capacity_(capacity > 0 ? capacity : 0) {
+    if(capacity_ == 0) {
+        throw std::invalid_argument("Lock-free queue capacity must be positive");
+    }
+    slots_ = std::make_unique<Slot[]>(capacity_);
+}
+
+bool LockFreeQueue::TryPush(Task& task) {
+    auto head = head_.load(std::memory_order_acquire);
+    while(true) {
+        Slot& slot = slots_[Index(head)];
+        if(slot.turn.load(std::memory_order_acquire) == 2 * Turn(head)) {
+            if(head_.compare_exchange_strong(head, head + 1, std::memory_order_seq_cst)) {
+                slot.task = std::move(task);
+                slot.turn.store(2 * Turn(head) + 1, std::memory_order_release);  // Слот готов для потребителя.
+                not_empty_.NotifyOne();
+                return true;
+            }
+            // CAS не удался - head уже перечитан, пробуем следующий слот.
+        }
+        else {
+            // Слот еще занят: либо очередь заполнена, либо другой производитель обогнал нас.
+            auto prev = head;
+            head      = head_.load(std::memory_order_acquire);
+            if(head == prev) {
+                return false;
+            }
+        }
+    }
+}
+
+void LockFreeQueue::Push(Task task) {
+    while(!TryPush(task)) {
+        // Паркуемся только тогда, когда после регистрации в not_full_ кольцо все еще заполнено.
+        auto key = not_full_.PrepareWait();
+        if(TryPush(task)) {
+            not_full_.CancelWait();
+            return;
+        }
+        not_full_.Wait(key);
+    }
+}
+
+bool LockFreeQueue::PushFor(Task& task, std::chrono::nanoseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto pause          = std::chrono::microseconds(1);
+    while(!TryPush(task)) {
+        const auto now = std::chrono::steady_clock::now();
+        if(now >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(pause, deadline - now));
+        pause = std::min(pause * 2, std::chrono::microseconds(1000));
+    }
+    return true;
+}
+
+size_t LockFreeQueue::PushDropOldest(Task task) {
+    // Между вытеснением и вставкой освободившийся слот может занять другой производитель - тогда вытесняем снова.
+    size_t evicted = 0;
+    while(!TryPush(task)) {
+        if(TryPop()) {
+            ++evicted;
+        }
+    }
+    return evicted;
+}
+
+size_t LockFreeQueue::PushBatch(std::span<Task> tasks) {
+    if(tasks.empty()) {
+        return 0;
+    }
+    // Мьютекса нет, поэтому пачка кладется поэлементно. NotifyOne() делает системный вызов, только если есть спящие
+    // потребители, так что будится не больше потоков, чем положено задач.
+    Push(std::move(tasks.front()));
+    size_t pushed = 1;
+    while(pushed < tasks.size() && TryPush(tasks[pushed])) {
+        ++pushed;
+    }
+    return pushed;
+}
+
+std::optional<Task> LockFreeQueue::TryPop() {
+    auto tail = tail_.load(std::memory_order_acquire);
+    while(true) {
+        Slot& slot = slots_[Index(tail)];
+        if(slot.turn.load(std::memory_order_acquire) == 2 * Turn(tail) + 1) {
+            if(tail_.compare_exchange_strong(tail, tail + 1, std::memory_order_seq_cst)) {
+                auto task = std::move(slot.task);
+                slot.task = nullptr;  // Освобождаем захваченные задачей ресурсы до переиспользования слота.
+                slot.turn.store(2 * Turn(tail) + 2, std::memory_order_release);  // Слот готов для производителя.
+                not_full_.NotifyOne();
+                return task;
+            }
+        }
+        else {
+            auto prev = tail;
+            tail      = tail_.load(std::memory_order_acquire);
+            if(tail == prev) {
+                return std::nullopt;
+            }
+        }
+    }
+}
+
+std::optional<Task> LockFreeQueue::Pop() {
+    while(true) {
+        if(auto task = TryPop()) {
+            return task;
+        }
+        auto key = not_empty_.PrepareWait();
+        if(auto task = TryPop()) {
+            not_empty_.CancelWait();
+            return task;
+        }
+        not_empty_.Wait(key);
+    }
+}
+
+size_t LockFreeQueue::TryPopBatch(std::span<Task> out) {
+    // Мьютекса нет - забираем поэлементно, каждый слот освобождается для производителей сразу.
+    size_t popped = 0;
+    while(popped < out.size()) {
+        auto task = TryPop();
+        if(!task) {
+            break;
+        }
+        out[popped++] = std::move(*task);
+    }
+    return popped;
+}
+
+size_t LockFreeQueue::Size() {
+    // Хвост читается первым: голова только растет, поэтому разность не бывает отрицательной. Позиции, занятые, но еще
+    // не заполненные производителями, тоже считаются.
+    const auto tail = tail_.load(std::memory_order_acquire);
+    const auto head = head_.load(std::memory_order_acquire);
+    return std::min(head - tail, capacity_);
+}
+
+}  // namespace dispatcher::queue
@@ -2,78 +2,577 @@
 
 #include <exception>
 #include <algorithm>
+#include <bit>
 #include <memory>
+#include <stdexcept>
+#include <thread>
 
 namespace dispatcher::queue {
 
 PriorityQueue::PriorityQueue(const std::map<TaskPriority, QueueOptions>& config) {
     for(const auto& [priority, options]: config) {
-        if(options.bounded) {
-            if(!options.capacity) {
-                throw std::invalid_argument("Bounded priority queue can't be based on zero capacity");
+        if(static_cast<size_t>(priority) >= kMaxPriorityLevels) {
+            throw std::invalid_argument("Priority level is out of range");
+        }
+        if(options.shards == 0) {
+            throw std::invalid_argument("Priority queue needs at least one shard");
+        }
+        if(options.bounded && !options.capacity) {
+            throw std::invalid_argument("Bounded priority queue can't be based on zero capacity");
+        }
+        if(!options.bounded && options.lock_free) {
+            throw std::invalid_argument("Lock-free priority queue must be bounded");
+        }
+
+        auto make = [&options](std::optional<int> capacity) -> std::unique_ptr<IQueue> {
+            if(!options.bounded) {
+                return std::make_unique<UnboundedQueue>();
             }
-            priority_queues_.try_emplace(priority, std::make_unique<BoundedQueue>(options.capacity.value()));
+            if(options.lock_free) {
+                return std::make_unique<LockFreeQueue>(capacity.value());
+            }
+            return std::make_unique<BoundedQueue>(capacity.value());
+        };
+        if(options.shards == 1) {
+            priority_queues_.try_emplace(priority, make(options.capacity));
         }
         else {
-            priority_queues_.try_emplace(priority, std::make_unique<UnboundedQueue>());
+            const auto shards = static_cast<int>(options.shards);
+            std::optional<int> capacity;
+            if(options.capacity) {
+                capacity = *options.capacity > 0 ? (*options.capacity + shards - 1) / shards : *options.capacity;
+            }
+            std::vector<std::unique_ptr<IQueue>> queues;
+            for(size_t shard = 0; shard < options.shards; ++shard) {
+                queues.push_back(make(capacity));
+            }
+            priority_queues_.try_emplace(priority, std::make_unique<ShardedQueue>(std::move(queues)));
+        }
+        const auto level = static_cast<size_t>(priority);
+        const uint64_t bit = uint64_t {1} << level;
+        levels_[level]     = priority_queues_.at(priority).get();
+
+        policy_[level].weight = options.weight;
+        policy_[level].credit = options.weight;
+        policy_[level].aging  = options.aging;
+        (options.weight > 0 ? weighted_ : strict_) |= bit;
+        if(options.aging > 0) {
+            aged_ |= bit;
+        }
+    }
+    in_credit_ = weighted_;
+
+    for(const auto& [priority, options]: config) {
+        const auto level = static_cast<size_t>(priority);
+        overflow_[level] = options.overflow;
+        const uint64_t below = (strict_ | weighted_) & ~((uint64_t {2} << level) - 1);
+        if(options.overflow == OverflowPolicy::Spill && below == 0) {
+            throw std::invalid_argument("Spill overflow policy requires a lower priority level");
+        }
+    }
+}
+
+bool PriorityQueue::HasLevel(TaskPriority priority) const {
+    // Набор очередей не меняется после конструктора, поэтому поиск не требует мьютекса PriorityQueue.
+    const auto level = static_cast<size_t>(priority);
+    return level < kMaxPriorityLevels && levels_[level];
+}
+
+IQueue& PriorityQueue::Level(TaskPriority priority) const {
+    if(!HasLevel(priority)) {
+        throw std::invalid_argument("Priority queue does not exist");
+    }
+    return *levels_[static_cast<size_t>(priority)];
+}
+
+std::optional<Task> PriorityQueue::ClearIfEmpty(size_t level) {
+    const uint64_t bit = uint64_t {1} << level;
+    non_empty_.fetch_and(~bit, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Производитель проверяет бит после вставки (см. MarkNonEmpty()). Если его вставка не видна повторной проверке,
+    // то он прочтет бит уже снятым и поднимет его снова.
+    if(auto task = levels_[level]->TryPop()) {
+        non_empty_.fetch_or(bit, std::memory_order_seq_cst);
+        return task;
+    }
+    return std::nullopt;
+}
+
+PushResult PriorityQueue::Push(TaskPriority priority, Task task, size_t* dropped) {
+    return Admit(priority, task, std::nullopt, dropped);
+}
+
+PushResult PriorityQueue::TryPush(TaskPriority priority, Task& task, size_t* dropped) {
+    return Admit(priority, task, std::chrono::nanoseconds::zero(), dropped);
+}
+
+PushResult PriorityQueue::PushFor(TaskPriority priority, Task& task, std::chrono::nanoseconds timeout,
+                                  size_t* dropped) {
+    return Admit(priority, task, std::max(timeout, std::chrono::nanoseconds(1)), dropped);
+}
+
+PushResult PriorityQueue::Admit(TaskPriority priority, Task& task, std::optional<std::chrono::nanoseconds> timeout,
+                                size_t* dropped) {
+    auto& queue      = Level(priority);
+    const auto level = static_cast<size_t>(priority);
+    if(dropped) {
+        *dropped = 0;
+    }
+    if(queue.TryPush(task)) {  // Обычный путь: место есть, политика не нужна.
+        Published(level);
+        return PushResult::Pushed;
+    }
+
+    auto& counters = overflow_counters_[level];
+    switch(overflow_[level]) {
+        case OverflowPolicy::Reject:
+            counters.rejected.fetch_add(1, std::memory_order_relaxed);
+            return PushResult::Rejected;
+        case OverflowPolicy::DropOldest: {
+            // Вытесняемую задачу забираем так же, как потребитель, - по разрешению, иначе разрешений станет больше, чем
+            // задач. Если разрешений нет, все задачи уже обещаны потребителям, и место вот-вот освободится.
+            size_t evicted = 0;
+            while(!queue.TryPush(task)) {
+                if(Acquire(1) == 0) {
+                    std::this_thread::yield();
+                }
+                else if(queue.TryPop()) {
+                    ++evicted;
+                }
+                else {
+                    Release(1);  // Разрешение было за задачу другого уровня.
+                }
+            }
+            counters.dropped_oldest.fetch_add(evicted, std::memory_order_relaxed);
+            if(dropped) {
+                *dropped = evicted;
+            }
+            Published(level);
+            return PushResult::DroppedOldest;
+        }
+        case OverflowPolicy::Spill:
+            // Нижние уровни перебираются от ближайшего; на каждом - только неблокирующая попытка.
+            for(auto mask = (strict_ | weighted_) & ~((uint64_t {2} << level) - 1); mask != 0; mask &= mask - 1) {
+                const auto lower = static_cast<size_t>(std::countr_zero(mask));
+                if(levels_[lower]->TryPush(task)) {
+                    counters.spilled.fetch_add(1, std::memory_order_relaxed);
+                    Published(lower);
+                    return PushResult::Spilled;
+                }
+            }
+            [[fallthrough]];
+        case OverflowPolicy::Block:
+            break;
+    }
+
+    if(timeout && *timeout == std::chrono::nanoseconds::zero()) {
+        counters.rejected.fetch_add(1, std::memory_order_relaxed);
+        return PushResult::Rejected;
+    }
+    counters.blocked.fetch_add(1, std::memory_order_relaxed);
+    if(!timeout) {
+        // В нашем случае дедлока не произойдет: мьютекс PriorityQueue здесь не захвачен, и воркеры, освобождающие
+        // место, не ждут производителя.
+        queue.Push(std::move(task));
+    }
+    else if(!queue.PushFor(task, *timeout)) {
+        counters.timed_out.fetch_add(1, std::memory_order_relaxed);
+        return PushResult::TimedOut;
+    }
+    Published(level);
+    return PushResult::Pushed;
+}
+
+OverflowStats PriorityQueue::GetOverflowStats(TaskPriority priority) const {
+    Level(priority);  // Бросает исключение для несуществующего уровня.
+    const auto& counters = overflow_counters_[static_cast<size_t>(priority)];
+    return {counters.blocked.load(std::memory_order_relaxed), counters.rejected.load(std::memory_order_relaxed),
+            counters.timed_out.load(std::memory_order_relaxed), counters.dropped_oldest.load(std::memory_order_relaxed),
+            counters.spilled.load(std::memory_order_relaxed)};
+}
+
+OverflowPolicy PriorityQueue::GetOverflowPolicy(TaskPriority priority) const {
+    Level(priority);  // Бросает исключение для несуществующего уровня.
+    return overflow_[static_cast<size_t>(priority)];
+}
+
+void PriorityQueue::PushBatch(TaskPriority priority, std::span<Task> tasks) {
+    if(tasks.empty()) {
+        return;
+    }
+    auto& queue = Level(priority);
+
+    while(!tasks.empty()) {
+        // Ограниченная очередь принимает пачку частями. Воркеров будим после каждой части, иначе при заполненной
+        // очереди производитель ждал бы места, которое некому освободить.
+        const size_t pushed = queue.PushBatch(tasks);
+        tasks               = tasks.subspan(pushed);
+        Publish(static_cast<size_t>(priority), pushed);
+        Wake(pushed);  // Будим столько воркеров, сколько задач положили.
+    }
+}
+
+size_t PriorityQueue::Acquire(size_t count) {
+    size_t available = available_.load(std::memory_order_relaxed);
+    while(available > 0) {
+        const size_t taken = std::min(available, count);
+        if(available_.compare_exchange_weak(available, available - taken, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+            return taken;
         }
     }
+    return 0;
 }
 
-void PriorityQueue::Push(TaskPriority priority, std::function<void()> task) {
-    std::unique_ptr<IQueue>* q_ptr = nullptr;
+void PriorityQueue::Wake(size_t count) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);  // Парный барьер к барьеру в Sleep().
+    const size_t sleeping = sleeping_.load(std::memory_order_relaxed);
+    if(sleeping == 0) {
+        return;  // Потребители заняты или крутятся в ожидании и сами увидят разрешения.
+    }
     {
-        std::lock_guard guard(mutex_);
-        if(auto queue_it = priority_queues_.find(priority); queue_it != priority_queues_.end()) {
-            q_ptr = &queue_it->second;
+        std::lock_guard lock(mutex_);
+    }
+    // Если спящих не больше, чем задач, хватит одного notify_all().
+    if(count < sleeping) {
+        for(size_t i = 0; i < count; ++i) {
+            cv_.notify_one();
+        }
+    }
+    else {
+        cv_.notify_all();
+    }
+}
+
+size_t PriorityQueue::TakeFrom(size_t level, std::span<Task> out) {
+    size_t popped = levels_[level]->TryPopBatch(out);
+    if(popped == 0) {
+        if(auto task = ClearIfEmpty(level)) {
+            out[0] = std::move(*task);
+            popped = 1 + levels_[level]->TryPopBatch(out.subspan(1));
+        }
+    }
+    return popped;
+}
+
+PriorityQueue::Batch PriorityQueue::TakeLocked(std::span<Task> out) {
+    // Сперва уровни, исчерпавшие порог старения: каждому вне очереди отдается одна задача.
+    for(auto mask = starving_; mask != 0; mask &= mask - 1) {
+        const auto level = static_cast<size_t>(std::countr_zero(mask));
+        if(TakeFrom(level, out.first(1)) > 0) {
+            Charge(level, 1);
+            return {PriorityLevel(level), 1};
+        }
+        starving_ &= ~(uint64_t {1} << level);
+        policy_[level].skipped = 0;
+    }
+
+    // Уровни перебираются от высшего приоритета к низшему, пустые пропускаются без обращения к их очередям. Уровни со
+    // строгим приоритетом участвуют всегда, уровни с весом - пока у них есть кредит раунда. Если задачи остались только
+    // у уровней без кредита, начинается новый раунд, и перебор повторяется.
+    for(int pass = 0; pass < 2; ++pass) {
+        for(auto mask = non_empty_.load(std::memory_order_seq_cst) & (strict_ | in_credit_); mask != 0;
+            mask &= mask - 1) {
+            const auto level = static_cast<size_t>(std::countr_zero(mask));
+            auto limit       = out;
+            if(weighted_ & (uint64_t {1} << level)) {
+                limit = out.first(std::min<size_t>(out.size(), policy_[level].credit));
+            }
+            if(const size_t popped = TakeFrom(level, limit); popped > 0) {
+                Charge(level, popped);
+                return {PriorityLevel(level), popped};
+            }
+        }
+
+        if((non_empty_.load(std::memory_order_seq_cst) & weighted_ & ~in_credit_) == 0) {
+            break;
+        }
+        for(auto mask = weighted_; mask != 0; mask &= mask - 1) {
+            auto& policy  = policy_[std::countr_zero(mask)];
+            policy.credit = policy.weight;
+        }
+        in_credit_ = weighted_;
+    }
+    return {};
+}
+
+PriorityQueue::Batch PriorityQueue::TakeStrict(std::span<Task> out) {
+    for(auto mask = non_empty_.load(std::memory_order_seq_cst); mask != 0; mask &= mask - 1) {
+        const auto level = static_cast<size_t>(std::countr_zero(mask));
+        if(const size_t popped = TakeFrom(level, out); popped > 0) {
+            return {PriorityLevel(level), popped};
+        }
+    }
+    return {};
+}
+
+PriorityQueue::Batch PriorityQueue::Take(std::span<Task> out) {
+    // Задач в очередях не меньше, чем выданных разрешений, но между разрешением и TryPop() задачу одного уровня может
+    // забрать другой потребитель, оставив взамен свою - на уровне, который мы уже прошли. Поэтому обход повторяется,
+    // пока задача не найдется; ждать приходится только окончания чужого обхода.
+    while(true) {
+        Batch batch;
+        if(IsStrict()) {
+            batch = TakeStrict(out);
         }
         else {
-            throw std::invalid_argument("Priority queue does not exist");
+            std::lock_guard lock(mutex_);
+            batch = TakeLocked(out);
+        }
+        if(batch.size > 0) {
+            if(batch.size < out.size()) {
+                Release(out.size() - batch.size);  // Остальные задачи на других уровнях.
+            }
+            return batch;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void PriorityQueue::Charge(size_t level, size_t popped) {
+    const uint64_t bit = uint64_t {1} << level;
+    auto& policy       = policy_[level];
+    if(weighted_ & bit) {
+        policy.credit -= std::min<size_t>(policy.credit, popped);
+        if(policy.credit == 0) {
+            in_credit_ &= ~bit;
         }
     }
+    if(aged_ == 0) {
+        return;
+    }
+    policy.skipped = 0;
+    starving_ &= ~bit;
+    for(auto mask = non_empty_.load(std::memory_order_relaxed) & aged_ & ~bit; mask != 0; mask &= mask - 1) {
+        const auto other = static_cast<size_t>(std::countr_zero(mask));
+        if(++policy_[other].skipped >= policy_[other].aging) {
+            starving_ |= uint64_t {1} << other;
+        }
+    }
+}
+
+std::optional<Task> PriorityQueue::Pop() {
+    SpinWait none;
+    return Pop(none);
+}
 
-    // В нашем случае дедлока не произойдет, если вызвать Push под мьютексом PriorityQueue, потому что логика
-    // приложения подразумевает строгий порядок захвата мьютексов потоками: 1. Мьютекс из PriorityQueue 2. Мьютекс
-    // подлежащей Bounded/UnboundedQueue. Однако то, что мы вынесли Push после разблокировки мьютекса немного повысит
-    // производительность при больших нагрузках.
-    (*q_ptr)->Push(std::move(task));
-    cv_.notify_one();
+std::optional<Task> PriorityQueue::Pop(SpinWait& spin) {
+    Task task;
+    if(PopBatch(std::span(&task, 1), spin).size == 0) {
+        return std::nullopt;
+    }
+    return task;
 }
 
-std::optional<std::function<void()>> PriorityQueue::Pop() {
+PriorityQueue::Batch PriorityQueue::PopBatch(std::span<Task> out) {
+    SpinWait none;
+    return PopBatch(out, none);
+}
+
+PriorityQueue::Batch PriorityQueue::PopBatch(std::span<Task> out, SpinWait& spin) {
+    if(out.empty()) {
+        return {};
+    }
+    while(true) {
+        FireDueTimers();
+        // active_ читаем до разрешений: Shutdown() вызывается после последней вставки, поэтому если очередь уже
+        // остановлена, а разрешений нет, то задач не осталось.
+        const bool active = active_.load(std::memory_order_acquire);
+        if(const size_t permits = Acquire(out.size()); permits > 0) {
+            return Take(out.first(permits));
+        }
+        if(!active) {
+            return {};  // Получили команду Shutdown(). В этой точке все задачи, которые взяли себе потоки в Pop(),
+                        // гарантированно завершены.
+        }
+
+        // Крутимся, читая только счетчик разрешений, а остальные потребители тем временем забирают задачи.
+        if(!spin.Enabled() || !spin.Wait([this] { return available_.load(std::memory_order_relaxed) > 0; })) {
+            Sleep();
+        }
+    }
+}
+
+void PriorityQueue::Sleep(const std::atomic<size_t>* pending) {
     std::unique_lock lock(mutex_);
+    sleeping_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);  // Парный барьер к барьеру в Wake() и WakeAll().
+    // Либо производитель после нашего объявления увидит sleeping_ > 0 и разбудит нас, либо мы увидим его разрешение.
+    // active_ перепроверяем, потому что Shutdown() мог разбудить всех, пока мы крутились без мьютекса.
+    const bool waiting = pending ? pending->load(std::memory_order_relaxed) != 0
+                                 : active_.load(std::memory_order_relaxed);
+    if(waiting && available_.load(std::memory_order_relaxed) == 0) {
+        if(auto next = timers_.NextExpiry()) {
+            cv_.wait_until(lock, *next);
+        }
+        else {
+            cv_.wait(lock);
+        }
+    }
+    sleeping_.fetch_sub(1, std::memory_order_relaxed);
+    if(pending && pending->load(std::memory_order_relaxed) == 0 && available_.load(std::memory_order_relaxed) > 0) {
+        // Ожидание кончилось, и задачу ожидающий может не взять: уведомление могло предназначаться ей, передаем его.
+        cv_.notify_one();
+    }
+}
 
-    while(true) {  // Просыпаемся и проверяем, что не было каманды Shutdown(), а очередь все еще активна. При этом
-                   // active_ должен менять свое состояние (другим потоком) только под тем же мьютексом. Because
-                   // cv_.wait(lock) only synchronizes visibility of writes that happened before the mutex was
-                   // unlocked in the notifying thread.
-        if(auto high = priority_queues_.find(TaskPriority::High); high != priority_queues_.cend()) {
-            if(auto task = high->second->TryPop()) {  // Сперва проверяем задачи с высоким приоритетом.
-                lock.unlock();  // Пусть потоки проснуться чуть раньше и смогут снова выполнять полезную работу.
-                return task;
-            }
+void PriorityQueue::SleepWhile(const std::atomic<size_t>& pending) {
+    Sleep(&pending);
+}
+
+void PriorityQueue::WakeAll() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);  // Парный барьер к барьеру в Sleep().
+    if(sleeping_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    {
+        std::lock_guard lock(mutex_);
+    }
+    cv_.notify_all();
+}
+
+TimerId PriorityQueue::ScheduleAfter(std::chrono::nanoseconds delay, TaskPriority priority, Task task) {
+    Level(priority);  // Бросает исключение для несуществующего уровня.
+    std::lock_guard lock(mutex_);
+    return Arm(TimerWheel::Clock::now() + delay, priority, std::move(task));
+}
+
+TimerId PriorityQueue::ScheduleEvery(std::chrono::nanoseconds period, TaskPriority priority, Task task) {
+    if(period <= std::chrono::nanoseconds::zero()) {
+        throw std::invalid_argument("Timer period must be positive");
+    }
+    Level(priority);
+
+    auto state      = std::make_shared<Periodic>();
+    state->task     = std::move(task);
+    state->period   = period;
+    state->priority = priority;
+
+    std::lock_guard lock(mutex_);
+    state->next = TimerWheel::Clock::now() + period;
+    // Задача таймера - лишь указатель на состояние, она помещается во встроенный буфер Task: запуски не аллоцируют.
+    state->current = Arm(state->next, priority, [this, state] { RunPeriodic(state); });
+    periodic_.emplace(state->current, state);
+    return state->current;
+}
+
+bool PriorityQueue::CancelTimer(TimerId id) {
+    std::lock_guard lock(mutex_);
+    if(auto it = periodic_.find(id); it != periodic_.end()) {
+        // Если запуск уже в очереди или выполняется, следующий не будет запланирован (см. RunPeriodic()).
+        it->second->cancelled = true;
+        timers_.Cancel(it->second->current);
+        periodic_.erase(it);
+        UpdateDue();
+        return true;
+    }
+    const bool cancelled = timers_.Cancel(id);
+    UpdateDue();
+    return cancelled;
+}
+
+TimerId PriorityQueue::Arm(TimerWheel::Clock::time_point deadline, TaskPriority priority, Task task) {
+    const auto earliest = timers_.NextExpiry();
+    const TimerId id    = timers_.Add(deadline, priority, std::move(task));
+    UpdateDue();
+    if(!earliest || deadline < *earliest) {
+        cv_.notify_all();  // Спящие без срока или с более поздним сроком пересчитают время ожидания.
+    }
+    return id;
+}
+
+void PriorityQueue::FireTimers() {
+    const auto now = TimerWheel::Clock::now();
+    timers_.Expire(now, expired_);
+    for(auto& [priority, task]: expired_) {
+        if(levels_[static_cast<size_t>(priority)]->TryPush(task)) {
+            Publish(static_cast<size_t>(priority), 1);
+            cv_.notify_one();  // Wake() захватил бы mutex_ повторно.
         }
-        if(auto normal = priority_queues_.find(TaskPriority::Normal); normal != priority_queues_.cend()) {
-            if(auto task = normal->second->TryPop()) {  // Только потом проверяем задачи с нормальным приоритетом.
-                lock.unlock();
-                return task;
-            }
+        else {
+            // Очередь уровня заполнена: ждать места под mutex_ нельзя, повторим на следующем тике. Срок now уже прошел,
+            // и потребители крутились бы на mutex_, вместо того чтобы спать до тика.
+            timers_.Add(now + timers_.Resolution(), priority, std::move(task));
         }
+    }
+    expired_.clear();
+    UpdateDue();
+}
 
-        if(!active_) {
-            return std::nullopt;  // Получили команду Shutdown(). В этой точке все задачи,
-                                  // которые взяли себе потоки в Pop(), гарантированно завершены.
+void PriorityQueue::FireDueTimers() {
+    const auto due = due_.load(std::memory_order_relaxed);
+    if(due == kNoTimers || TimerWheel::Clock::now().time_since_epoch().count() < due) {
+        return;
+    }
+    std::lock_guard lock(mutex_);
+    if(active_.load(std::memory_order_relaxed)) {
+        FireTimers();
+    }
+}
+
+void PriorityQueue::UpdateDue() {
+    const auto next = timers_.NextExpiry();
+    due_.store(next ? next->time_since_epoch().count() : kNoTimers, std::memory_order_relaxed);
+}
+
+void PriorityQueue::RunPeriodic(const std::shared_ptr<Periodic>& state) {
+    {
+        std::lock_guard lock(mutex_);
+        if(state->cancelled) {
+            return;
         }
+    }
+    try {
+        state->task();
+    }
+    catch(...) {
+        Rearm(state);  // Исключение одного запуска не отменяет следующие.
+        throw;
+    }
+    Rearm(state);
+}
 
-        cv_.wait(lock);  // Засыпаем и отпускаем мьютекс.
+void PriorityQueue::Rearm(const std::shared_ptr<Periodic>& state) {
+    std::lock_guard lock(mutex_);
+    if(state->cancelled || !active_) {
+        return;
+    }
+    state->next    = std::max(state->next + state->period, TimerWheel::Clock::now());
+    state->current = Arm(state->next, state->priority, [this, state] { RunPeriodic(state); });
+}
+
+size_t PriorityQueue::Size() const {
+    size_t size = 0;
+    for(const auto& [priority, queue]: priority_queues_) {
+        size += queue->Size();
+    }
+    return size;
+}
+
+std::optional<Task> PriorityQueue::TryPop(TaskPriority priority) {
+    // Занятый воркер с кражей задач доходит до Pop(), только когда работы нет, поэтому таймеры проверяем и здесь:
+    // иначе под постоянной нагрузкой отложенные задачи не срабатывали бы.
+    FireDueTimers();
+    const auto level = static_cast<size_t>(priority);
+    if(level >= kMaxPriorityLevels || !levels_[level]) {
+        return std::nullopt;
+    }
+    // Пустой уровень отсекаем по маске, не трогая счетчик разрешений: воркеры спрашивают так каждый уровень подряд.
+    if((non_empty_.load(std::memory_order_relaxed) & (uint64_t {1} << level)) == 0 || Acquire(1) == 0) {
+        return std::nullopt;
+    }
+    if(auto task = levels_[level]->TryPop()) {  // Бит уровня снимет Pop(), если очередь опустеет.
+        return task;
     }
+    Release(1);  // Разрешение было за задачу другого уровня.
+    return std::nullopt;
 }
 
 void PriorityQueue::Shutdown() {
     {
         std::lock_guard lock(mutex_);  // Синхронизируемся обязательно под тем же мьютексом, что и cv_ в Pop(). Только
                                        // так код внутри cv_ увидит актулаьные значения разделяемых данных.
-        active_ = false;
+        active_.store(false, std::memory_order_release);
     }
     cv_.notify_all();  // Пробуждаем в Pop() все спящие потоки - корректно завершаем работу.
 }
@@ -0,0 +1,136 @@
+#include "queue/sharded_queue.hpp"
+
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace dispatcher::queue {
+
+namespace {
+
+// xorshift64*: на выбор шарда хватает, а состояние - одно слово в thread_local.
+uint64_t NextRandom() {
+    thread_local uint64_t state = std::hash<std::thread::id> {}(std::this_thread::get_id()) | 1;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+}  // namespace
+
+ShardedQueue::ShardedQueue(std::vector<std::unique_ptr<IQueue>> shards): shards_(shards.size()) {
+    if(shards.empty()) {
+        throw std::invalid_argument("Sharded queue needs at least one shard");
+    }
+    for(size_t i = 0; i < shards.size(); ++i) {
+        shards_[i].queue = std::move(shards[i]);
+    }
+}
+
+size_t ShardedQueue::Pick() const {
+    return static_cast<size_t>(NextRandom() % shards_.size());
+}
+
+size_t ShardedQueue::PickLonger() const {
+    const size_t first  = Pick();
+    const size_t second = Pick();
+    if(shards_[second].size.load(std::memory_order_relaxed) > shards_[first].size.load(std::memory_order_relaxed)) {
+        return second;
+    }
+    return first;
+}
+
+void ShardedQueue::Push(Task task) {
+    auto& shard = shards_[Pick()];
+    shard.queue->Push(std::move(task));
+    shard.size.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ShardedQueue::TryPush(Task& task) {
+    const size_t start = Pick();
+    for(size_t i = 0; i < shards_.size(); ++i) {
+        auto& shard = shards_[(start + i) % shards_.size()];
+        if(shard.queue->TryPush(task)) {
+            shard.size.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ShardedQueue::PushFor(Task& task, std::chrono::nanoseconds timeout) {
+    if(TryPush(task)) {
+        return true;
+    }
+    auto& shard = shards_[Pick()];
+    if(!shard.queue->PushFor(task, timeout)) {
+        return false;
+    }
+    shard.size.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t ShardedQueue::PushDropOldest(Task task) {
+    if(TryPush(task)) {
+        return 0;
+    }
+    // Все шарды заполнены: вытесняем самую старую задачу случайного шарда.
+    auto& shard          = shards_[Pick()];
+    const size_t dropped = shard.queue->PushDropOldest(std::move(task));
+    shard.size.fetch_add(1 - static_cast<int64_t>(dropped), std::memory_order_relaxed);
+    return dropped;
+}
+
+size_t ShardedQueue::PushBatch(std::span<Task> tasks) {
+    auto& shard         = shards_[Pick()];
+    const size_t pushed = shard.queue->PushBatch(tasks);
+    shard.size.fetch_add(static_cast<int64_t>(pushed), std::memory_order_relaxed);
+    return pushed;
+}
+
+size_t ShardedQueue::TryPopBatch(std::span<Task> out) {
+    if(out.empty()) {
+        return 0;
+    }
+    const size_t start = PickLonger();
+    for(size_t i = 0; i < shards_.size(); ++i) {
+        auto& shard = shards_[(start + i) % shards_.size()];
+        if(const size_t popped = shard.queue->TryPopBatch(out); popped > 0) {
+            shard.size.fetch_sub(static_cast<int64_t>(popped), std::memory_order_relaxed);
+            return popped;
+        }
+    }
+    return 0;
+}
+
+size_t ShardedQueue::Size() {
+    size_t size = 0;
+    for(auto& shard: shards_) {
+        size += shard.queue->Size();
+    }
+    return size;
+}
+
+std::optional<Task> ShardedQueue::TryPop() {
+    const size_t start = PickLonger();
+    for(size_t i = 0; i < shards_.size(); ++i) {
+        auto& shard = shards_[(start + i) % shards_.size()];
+        if(auto task = shard.queue->TryPop()) {
+            shard.size.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<Task> ShardedQueue::Pop() {
+    while(true) {
+        if(auto task = TryPop()) {
+            return task;
+        }
+        std::this_thread::yield();
+    }
+}
+
+}  // namespace dispatcher::queue
@@ -0,0 +1,60 @@
+#include "queue/task_storage.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace dispatcher::queue {
+
+TaskRing::TaskRing(size_t capacity): capacity_(capacity) {
+    if(capacity_ == 0) {
+        throw std::invalid_argument("Task ring capacity must be positive");
+    }
+    slots_ = std::make_unique<Task[]>(capacity_);
+}
+
+TaskSegmentList::~TaskSegmentList() {
+    for(auto* list: {head_, free_}) {
+        while(list) {
+            delete std::exchange(list, list->next);
+        }
+    }
+}
+
+void TaskSegmentList::Grow() {
+    Segment* segment;
+    if(free_) {
+        segment = std::exchange(free_, free_->next);
+        --free_count_;
+    }
+    else {
+        segment = new Segment;
+        ++segments_;
+    }
+    segment->next = nullptr;
+
+    if(tail_) {
+        tail_->next = segment;
+    }
+    else {
+        head_ = segment;
+    }
+    tail_       = segment;
+    tail_index_ = 0;
+}
+
+void TaskSegmentList::Shrink() {
+    // Все задачи сегмента уже перемещены, пустые Task ничего не удерживают.
+    Segment* segment = std::exchange(head_, head_->next);
+    head_index_      = 0;
+    if(free_count_ < kMaxFreeSegments) {
+        segment->next = free_;
+        free_         = segment;
+        ++free_count_;
+    }
+    else {
+        delete segment;
+        --segments_;
+    }
+}
+
+}  // namespace dispatcher::queue
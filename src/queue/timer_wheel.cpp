@@ -0,0 +1,190 @@
+#include "queue/timer_wheel.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace dispatcher::queue {
+
+namespace {
+
+constexpr uint64_t Span(size_t level) {
+    return uint64_t {1} << (TimerWheel::kSlotBits * level);
+}
+
+}  // namespace
+
+TimerWheel::TimerWheel(Clock::duration tick, Clock::time_point origin): tick_(tick), origin_(origin) {
+    for(auto& level: heads_) {
+        level.fill(kNil);
+    }
+}
+
+TimerId TimerWheel::Add(Clock::time_point deadline, TaskPriority priority, Task task) {
+    uint32_t index;
+    if(free_ != kNil) {
+        index = free_;
+        free_ = nodes_[index].next;
+    }
+    else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    // Округляем срок вверх до тика, чтобы таймер не сработал раньше. Прошедший срок - ближайший необработанный тик.
+    const auto at    = std::max(deadline - origin_, Clock::duration::zero());
+    const auto ticks = static_cast<uint64_t>((at + tick_ - Clock::duration(1)) / tick_);
+    auto& node       = nodes_[index];
+    node.deadline    = std::max(ticks, now_ + 1);
+    node.priority    = priority;
+    node.task        = std::move(task);
+    Place(index);
+    ++size_;
+    return MakeId(index, node.generation);
+}
+
+bool TimerWheel::Cancel(TimerId id) {
+    const auto index = static_cast<uint32_t>(id);
+    if(index >= nodes_.size()) {
+        return false;
+    }
+    auto& node = nodes_[index];
+    if(node.generation != static_cast<uint32_t>(id >> 32) || !node.linked) {
+        return false;
+    }
+    Unlink(index);
+    Free(index);
+    --size_;
+    return true;
+}
+
+void TimerWheel::Place(uint32_t index) {
+    const uint64_t deadline = nodes_[index].deadline;
+    const uint64_t delta    = deadline - now_;  // > 0: прошедшие сроки Place() не получает.
+    size_t level            = 0;
+    while(level + 1 < kLevels && delta >= Span(level + 1)) {
+        ++level;
+    }
+    // Срок за пределами колеса: таймер ждет в самом дальнем слоте старшего уровня и при осыпании будет переложен.
+    const uint64_t placed = std::min(deadline, now_ + Span(kLevels) - 1);
+    Link(index, level, (placed >> (kSlotBits * level)) & (kSlots - 1));
+}
+
+void TimerWheel::Link(uint32_t index, size_t level, size_t slot) {
+    auto& node  = nodes_[index];
+    node.level  = static_cast<uint8_t>(level);
+    node.slot   = static_cast<uint8_t>(slot);
+    node.prev   = kNil;
+    node.next   = heads_[level][slot];
+    node.linked = true;
+    if(node.next != kNil) {
+        nodes_[node.next].prev = index;
+    }
+    heads_[level][slot] = index;
+    occupied_[level] |= uint64_t {1} << slot;
+}
+
+void TimerWheel::Unlink(uint32_t index) {
+    auto& node = nodes_[index];
+    if(node.prev != kNil) {
+        nodes_[node.prev].next = node.next;
+    }
+    else {
+        heads_[node.level][node.slot] = node.next;
+        if(node.next == kNil) {
+            occupied_[node.level] &= ~(uint64_t {1} << node.slot);
+        }
+    }
+    if(node.next != kNil) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.linked = false;
+}
+
+void TimerWheel::Free(uint32_t index) {
+    auto& node = nodes_[index];
+    node.task  = nullptr;
+    ++node.generation;
+    node.next = free_;
+    free_     = index;
+}
+
+void TimerWheel::Expire(Clock::time_point now, std::vector<Expired>& out) {
+    if(now < origin_) {
+        return;
+    }
+    const auto target = static_cast<uint64_t>((now - origin_) / tick_);
+    // Идем только по тикам, на которых что-то происходит: простой колеса не стоит ничего.
+    while(auto next = NextTick()) {
+        if(*next > target) {
+            break;
+        }
+        now_ = *next;
+        Tick(out);
+    }
+    now_ = std::max(now_, target);
+}
+
+void TimerWheel::Tick(std::vector<Expired>& out) {
+    for(size_t level = kLevels - 1; level > 0; --level) {
+        if(now_ % Span(level) != 0) {
+            continue;
+        }
+        const size_t slot   = (now_ >> (kSlotBits * level)) & (kSlots - 1);
+        uint32_t index      = heads_[level][slot];
+        heads_[level][slot] = kNil;
+        occupied_[level] &= ~(uint64_t {1} << slot);
+        while(index != kNil) {
+            const uint32_t next = nodes_[index].next;
+            if(nodes_[index].deadline <= now_) {
+                nodes_[index].linked = false;
+                out.push_back({nodes_[index].priority, std::move(nodes_[index].task)});
+                Free(index);
+                --size_;
+            }
+            else {
+                Place(index);
+            }
+            index = next;
+        }
+    }
+
+    const size_t slot = now_ & (kSlots - 1);
+    uint32_t index    = heads_[0][slot];
+    heads_[0][slot]   = kNil;
+    occupied_[0] &= ~(uint64_t {1} << slot);
+    while(index != kNil) {
+        const uint32_t next  = nodes_[index].next;
+        nodes_[index].linked = false;
+        out.push_back({nodes_[index].priority, std::move(nodes_[index].task)});
+        Free(index);
+        --size_;
+        index = next;
+    }
+}
+
+std::optional<uint64_t> TimerWheel::NextTick() const {
+    std::optional<uint64_t> earliest;
+    for(size_t level = 0; level < kLevels; ++level) {
+        if(occupied_[level] == 0) {
+            continue;
+        }
+        // Слоты уровня обходятся по кругу начиная со следующего за текущим: текущий слот уже осыпан (или обработан) и
+        // содержит только таймеры следующего оборота. Осыпание старшего колеса может случиться раньше срока таймеров
+        // младшего, поэтому берем минимум по всем уровням.
+        const uint64_t position = now_ >> (kSlotBits * level);
+        const auto from         = static_cast<int>((position + 1) & (kSlots - 1));
+        const auto ahead        = static_cast<uint64_t>(std::countr_zero(std::rotr(occupied_[level], from)));
+        const uint64_t tick     = (position + 1 + ahead) << (kSlotBits * level);
+        earliest                = std::min(earliest.value_or(tick), tick);
+    }
+    return earliest;
+}
+
+std::optional<TimerWheel::Clock::time_point> TimerWheel::NextExpiry() const {
+    if(auto tick = NextTick()) {
+        return origin_ + tick_ * static_cast<Clock::rep>(*tick);
+    }
+    return std::nullopt;
+}
+
+}  // namespace dispatcher::queue
@@ -2,31 +2,75 @@
 
 namespace dispatcher::queue {
 
-void UnboundedQueue::Push(std::function<void()> task) {
+void UnboundedQueue::Push(Task task) {
     std::lock_guard lock(mutex_);
-    queue_.push(std::move(task));
+    queue_.Push(std::move(task));
     not_empty_.notify_one();
 }
 
-std::optional<std::function<void()>> UnboundedQueue::Pop() {
+bool UnboundedQueue::TryPush(Task& task) {
+    Push(std::move(task));  // Неограниченная очередь не бывает заполненной.
+    return true;
+}
+
+bool UnboundedQueue::PushFor(Task& task, std::chrono::nanoseconds) {
+    Push(std::move(task));
+    return true;
+}
+
+size_t UnboundedQueue::PushDropOldest(Task task) {
+    Push(std::move(task));
+    return 0;
+}
+
+size_t UnboundedQueue::PushBatch(std::span<Task> tasks) {
+    if(tasks.empty()) {
+        return 0;
+    }
+    std::lock_guard lock(mutex_);
+    for(auto& task: tasks) {
+        queue_.Push(std::move(task));
+    }
+    if(tasks.size() == 1) {
+        not_empty_.notify_one();
+    }
+    else {
+        not_empty_.notify_all();
+    }
+    return tasks.size();
+}
+
+std::optional<Task> UnboundedQueue::Pop() {
     std::unique_lock lock(mutex_);
-    not_empty_.wait(lock, [&] { return !queue_.empty(); });
-    auto task = std::move(queue_.front());
-    queue_.pop();
+    not_empty_.wait(lock, [&] { return !queue_.Empty(); });
+    auto task = queue_.Pop();
     lock.unlock();
     return task;
 }
 
-std::optional<std::function<void()>> UnboundedQueue::TryPop() {
+std::optional<Task> UnboundedQueue::TryPop() {
     mutex_.lock();
-    if(queue_.empty()) {
+    if(queue_.Empty()) {
         mutex_.unlock();
         return std::nullopt;
     }
-    auto task = std::move(queue_.front());
-    queue_.pop();
+    auto task = queue_.Pop();
     mutex_.unlock();
     return task;
 }
 
+size_t UnboundedQueue::TryPopBatch(std::span<Task> out) {
+    std::lock_guard lock(mutex_);
+    size_t popped = 0;
+    while(popped < out.size() && !queue_.Empty()) {
+        out[popped++] = queue_.Pop();
+    }
+    return popped;
+}
+
+size_t UnboundedQueue::Size() {
+    std::lock_guard lock(mutex_);
+    return queue_.Size();
+}
+
 }  // namespace dispatcher::queue
@@ -0,0 +1,115 @@
+#include "strand.hpp"
+
+#include <exception>
+#include <optional>
+#include <print>
+
+namespace dispatcher {
+
+Strand::State::State(TaskDispatcher& dispatcher, TaskPriority priority):
+    dispatcher(&dispatcher),
+    priority(priority),
+    tail(&stub),
+    head(&stub) {}
+
+Strand::State::~State() {
+    // Остались задачи, обработчик которых TaskDispatcher уничтожил без выполнения.
+    for(Node* node = head; node != nullptr;) {
+        Node* next = node->next.load(std::memory_order_relaxed);
+        if(node != &stub) {
+            delete node;
+        }
+        node = next;
+    }
+}
+
+void Strand::State::Push(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = tail.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);  // До этой строки узел не виден обработчику.
+}
+
+Strand::Node* Strand::State::Pop() {
+    Node* first = head;
+    Node* next  = first->next.load(std::memory_order_acquire);
+    if(first == &stub) {
+        if(next == nullptr) {
+            return nullptr;
+        }
+        head  = next;
+        first = next;
+        next  = next->next.load(std::memory_order_acquire);
+    }
+    if(next != nullptr) {
+        head = next;
+        return first;
+    }
+    if(first != tail.load(std::memory_order_acquire)) {
+        return nullptr;  // Производитель уже занял место за first, но еще не связал узел.
+    }
+    // first - последний узел: возвращаем заглушку в конец, чтобы забрать first, не оставив очередь без узлов.
+    Push(&stub);
+    next = first->next.load(std::memory_order_acquire);
+    if(next != nullptr) {
+        head = next;
+        return first;
+    }
+    return nullptr;
+}
+
+Strand::Strand(TaskDispatcher& dispatcher, TaskPriority priority):
+    state_(std::make_shared<State>(dispatcher, priority)) {}
+
+void Strand::Schedule(Task task) {
+    auto* node = new Node;
+    node->task = std::move(task);
+    state_->Push(node);
+    // Обработчик запускает тот, кто перевел счетчик из нуля. Пока счетчик не ноль, обработчик работает или стоит в
+    // очереди и сам найдет узел.
+    if(state_->pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        Dispatch(state_);
+    }
+}
+
+void Strand::Dispatch(const std::shared_ptr<State>& state) {
+    // Обработчик уходит в общую очередь, а не в локальную воркера: иначе воркер, уступивший его после kDrainBatch
+    // задач, тут же взял бы его обратно.
+    while(!state->dispatcher->Admit(
+        state->priority,
+        [state] {
+            if(Drain(*state)) {
+                Dispatch(state);
+            }
+        },
+        std::nullopt, false)) {
+        if(!Drain(*state)) {
+            return;
+        }
+    }
+}
+
+bool Strand::Drain(State& state) {
+    for(size_t done = 0; done < kDrainBatch; ++done) {
+        Node* node = state.Pop();
+        if(node == nullptr) {
+            // Счетчик уже учел задачу, а узел еще не связан. Не ждем производителя на воркере, а встаем в очередь.
+            return true;
+        }
+        try {
+            node->task();
+        }
+        catch(const std::exception& e) {
+            std::println("Exception thrown while running strand task: {}", e.what());
+        }
+        catch(...) {
+            std::println("Unknown exception thrown while running strand task");
+        }
+        delete node;
+        if(state.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            return false;  // Задач нет: следующая задача запустит новый обработчик.
+        }
+    }
+    return true;
+}
+
+}  // namespace dispatcher
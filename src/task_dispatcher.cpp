@@ -1,13 +1,122 @@
 #include "task_dispatcher.hpp"
 
+#include "strand.hpp"
+
 namespace dispatcher {
 
-TaskDispatcher::TaskDispatcher(size_t thread_count, const std::map<TaskPriority, queue::QueueOptions>& config):
-    pq_(std::make_shared<queue::PriorityQueue>(config)),
-    tp_(std::make_unique<thread_pool::ThreadPool>(pq_, thread_count)) {}
+TaskDispatcher::TaskDispatcher(size_t thread_count, const std::map<TaskPriority, queue::QueueOptions>& config,
+                               thread_pool::ThreadPoolOptions pool_options, bool collect_metrics):
+    pq_(std::make_shared<queue::PriorityQueue>(config)) {
+    if(collect_metrics) {
+        std::vector<TaskPriority> priorities;
+        for(const auto& [priority, options]: config) {
+            priorities.push_back(priority);
+        }
+        metrics_ = std::make_unique<metrics::Metrics>(priorities);
+    }
+    tp_ = std::make_unique<thread_pool::ThreadPool>(pq_, thread_count, pool_options);
+}
+
+bool TaskDispatcher::Schedule(TaskPriority priority, Task task) {
+    return Admit(priority, std::move(task), std::nullopt);
+}
+
+bool TaskDispatcher::TrySchedule(TaskPriority priority, Task task) {
+    return Admit(priority, std::move(task), std::chrono::nanoseconds::zero());
+}
+
+bool TaskDispatcher::ScheduleFor(TaskPriority priority, Task task, std::chrono::nanoseconds timeout) {
+    return Admit(priority, std::move(task), timeout);
+}
+
+bool TaskDispatcher::Admit(TaskPriority priority, Task task, std::optional<std::chrono::nanoseconds> timeout,
+                           bool local) {
+    if(metrics_) {
+        task = metrics_->Instrument(priority, std::move(task));
+    }
+    if(local && tp_->TryPushLocal(priority, task)) {
+        return true;  // Задача запланирована изнутри воркера и осталась в его локальной очереди.
+    }
+
+    queue::PushResult result;
+    size_t dropped = 0;
+    if(!timeout) {
+        result = pq_->Push(priority, std::move(task), &dropped);
+    }
+    else if(*timeout <= std::chrono::nanoseconds::zero()) {
+        result = pq_->TryPush(priority, task, &dropped);
+    }
+    else {
+        result = pq_->PushFor(priority, task, *timeout, &dropped);
+    }
+
+    switch(result) {
+        case queue::PushResult::Pushed:
+        case queue::PushResult::Spilled:
+            return true;
+        case queue::PushResult::DroppedOldest:
+            if(metrics_ && dropped > 0) {
+                metrics_->Discard(priority, dropped);  // Вытеснены задачи того же уровня, сколько бы их ни было.
+            }
+            return true;
+        case queue::PushResult::Rejected:
+        case queue::PushResult::TimedOut:
+            if(metrics_) {
+                metrics_->Discard(priority);
+            }
+            return false;
+    }
+    return false;
+}
+
+void TaskDispatcher::ScheduleBulk(TaskPriority priority, std::span<Task> tasks) {
+    if(metrics_) {
+        for(auto& task: tasks) {
+            task = metrics_->Instrument(priority, std::move(task));
+        }
+    }
+    pq_->PushBatch(priority, tasks);
+}
+
+void TaskDispatcher::CheckPriority(TaskPriority priority) const {
+    if(!pq_->HasLevel(priority)) {
+        throw std::invalid_argument("Priority queue does not exist");
+    }
+}
+
+Strand TaskDispatcher::MakeStrand(TaskPriority priority) {
+    CheckPriority(priority);
+    if(pq_->GetOverflowPolicy(priority) == queue::OverflowPolicy::DropOldest) {
+        throw std::invalid_argument("Strand priority must not use DropOldest overflow policy");
+    }
+    return Strand(*this, priority);
+}
+
+std::optional<metrics::Snapshot> TaskDispatcher::GetMetrics() const {
+    if(!metrics_) {
+        return std::nullopt;
+    }
+    return metrics_->Collect();
+}
+
+queue::TimerId TaskDispatcher::ScheduleAfter(std::chrono::nanoseconds delay, TaskPriority priority, Task task) {
+    return pq_->ScheduleAfter(delay, priority, std::move(task));
+}
+
+queue::TimerId TaskDispatcher::ScheduleEvery(std::chrono::nanoseconds period, TaskPriority priority, Task task) {
+    return pq_->ScheduleEvery(period, priority, std::move(task));
+}
+
+bool TaskDispatcher::CancelTimer(queue::TimerId id) {
+    return pq_->CancelTimer(id);
+}
+
+queue::OverflowStats TaskDispatcher::GetOverflowStats(TaskPriority priority) const {
+    return pq_->GetOverflowStats(priority);
+}
 
-void TaskDispatcher::Schedule(TaskPriority priority, std::function<void()> task) {
-    pq_->Push(priority, std::move(task));
+bool TaskDispatcher::HasPriority(TaskPriority priority) const {
+    return pq_->HasLevel(priority);
 }
 
 }  // namespace dispatcher
@@ -0,0 +1,161 @@
+#include "task_graph.hpp"
+
+#include <stdexcept>
+
+namespace dispatcher {
+
+TaskGraph::NodeId TaskGraph::AddNode(TaskPriority priority, Task work) {
+    if(!work) {
+        throw std::invalid_argument("Task graph node must have a task");
+    }
+    nodes_.push_back({priority, std::move(work), {}});
+    return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+void TaskGraph::AddEdge(NodeId before, NodeId after) {
+    if(before >= nodes_.size() || after >= nodes_.size()) {
+        throw std::invalid_argument("Unknown task graph node");
+    }
+    nodes_[before].successors.push_back(after);
+}
+
+ExecutableGraph TaskGraph::Instantiate() {
+    auto plan         = std::make_shared<ExecutableGraph::Plan>();
+    const size_t size = nodes_.size();
+    plan->in_degree.assign(size, 0);
+    plan->offsets.reserve(size + 1);
+    plan->offsets.push_back(0);
+    for(const auto& node: nodes_) {
+        for(auto successor: node.successors) {
+            ++plan->in_degree[successor];
+            plan->successors.push_back(successor);
+        }
+        plan->offsets.push_back(static_cast<uint32_t>(plan->successors.size()));
+    }
+
+    // Алгоритм Кана: если обойти в топологическом порядке удалось не все узлы, в графе есть цикл.
+    std::vector<uint32_t> degree = plan->in_degree;
+    std::vector<uint32_t> ready;
+    for(uint32_t node = 0; node < size; ++node) {
+        if(degree[node] == 0) {
+            ready.push_back(node);
+        }
+    }
+    plan->roots = ready;
+    size_t visited = 0;
+    while(!ready.empty()) {
+        const auto node = ready.back();
+        ready.pop_back();
+        ++visited;
+        for(auto i = plan->offsets[node]; i < plan->offsets[node + 1]; ++i) {
+            if(--degree[plan->successors[i]] == 0) {
+                ready.push_back(plan->successors[i]);
+            }
+        }
+    }
+    if(visited != size) {
+        throw std::invalid_argument("Task graph has a cycle");
+    }
+
+    plan->priorities.reserve(size);
+    plan->work.reserve(size);
+    for(auto& node: nodes_) {
+        plan->priorities.push_back(node.priority);
+        plan->work.push_back(std::move(node.work));
+    }
+    nodes_.clear();
+    return ExecutableGraph(std::move(plan));
+}
+
+Future<void> ExecutableGraph::Run(TaskDispatcher& dispatcher) const {
+    // Проверяем заранее: узел с ненастроенным приоритетом обнаружился бы только при постановке, когда часть графа уже
+    // выполнена.
+    if(plan_) {
+        for(auto priority: plan_->priorities) {
+            if(!dispatcher.HasPriority(priority)) {
+                throw std::invalid_argument("Task graph node priority is not configured");
+            }
+        }
+    }
+
+    auto execution    = std::make_unique<Execution>();
+    auto future       = execution->promise.GetFuture();
+    const size_t size = Size();
+    if(size == 0) {
+        execution->promise.SetValue();
+        return future;
+    }
+    execution->plan       = plan_;
+    execution->dispatcher = &dispatcher;
+    execution->pending    = std::make_unique<std::atomic<uint32_t>[]>(size);
+    for(size_t node = 0; node < size; ++node) {
+        execution->pending[node].store(plan_->in_degree[node], std::memory_order_relaxed);
+    }
+    execution->remaining.store(size, std::memory_order_relaxed);
+
+    // Дальше запуском владеют его узлы: последний завершившийся удалит его.
+    auto* owned = execution.release();
+    for(auto root: plan_->roots) {
+        Submit(owned, root);
+    }
+    return future;
+}
+
+void ExecutableGraph::Submit(Execution* execution, uint32_t node) {
+    const auto priority = execution->plan->priorities[node];
+    std::exception_ptr error;
+    try {
+        if(execution->dispatcher->Schedule(priority, [execution, node] { Execute(execution, node); })) {
+            return;
+        }
+        error = std::make_exception_ptr(std::runtime_error("Task graph node rejected by overflow policy"));
+    }
+    catch(...) {
+        // Исключение нельзя выпускать: Submit() вызывается и из задачи воркера, и тогда Future не был бы готов никогда.
+        error = std::current_exception();
+    }
+    Fail(execution, std::move(error));
+    Finish(execution, node);
+}
+
+void ExecutableGraph::Execute(Execution* execution, uint32_t node) {
+    if(!execution->failed.load(std::memory_order_acquire)) {
+        try {
+            execution->plan->work[node]();
+        }
+        catch(...) {
+            Fail(execution, std::current_exception());
+        }
+    }
+    Finish(execution, node);
+}
+
+void ExecutableGraph::Finish(Execution* execution, uint32_t node) {
+    const auto& plan = *execution->plan;
+    for(auto i = plan.offsets[node]; i < plan.offsets[node + 1]; ++i) {
+        const auto successor = plan.successors[i];
+        if(execution->pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Submit(execution, successor);
+        }
+    }
+    if(execution->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    // Последний узел: все остальные уже отработали, и их записи видны благодаря acq_rel на remaining.
+    std::unique_ptr<Execution> owned(execution);
+    if(owned->error) {
+        owned->promise.SetException(owned->error);
+    }
+    else {
+        owned->promise.SetValue();
+    }
+}
+
+void ExecutableGraph::Fail(Execution* execution, std::exception_ptr error) {
+    bool expected = false;
+    if(execution->failed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+        execution->error = std::move(error);
+    }
+}
+
+}  // namespace dispatcher
@@ -0,0 +1,75 @@
+#include "task_group.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace dispatcher {
+
+TaskGroup::~TaskGroup() {
+    try {
+        Wait();
+    }
+    catch(...) {
+    }
+}
+
+void TaskGroup::Post(TaskPriority priority, Task job) {
+    dispatcher_.CheckPriority(priority);
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    bool accepted;
+    try {
+        accepted = dispatcher_.Schedule(priority, std::move(job));
+    }
+    catch(...) {
+        Finish();  // Задача не поставлена, и ждать ее нельзя.
+        throw;
+    }
+    if(!accepted) {
+        Finish();
+        throw std::runtime_error("Task group task rejected by overflow policy");
+    }
+}
+
+void TaskGroup::Fail(std::exception_ptr error) {
+    std::lock_guard lock(mutex_);
+    if(!error_) {
+        error_ = std::move(error);
+    }
+}
+
+void TaskGroup::Finish() {
+    std::lock_guard lock(mutex_);
+    if(pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        cv_.notify_all();
+        dispatcher_.pq_->WakeAll();  // Воркеры ждут в Wait() на cv_ очереди (см. PriorityQueue::SleepWhile()).
+    }
+}
+
+void TaskGroup::Wait() {
+    auto* pool           = dispatcher_.tp_.get();
+    const bool on_worker = pool->OnWorker();
+    while(pending_.load(std::memory_order_acquire) != 0) {
+        if(on_worker) {
+            if(!pool->RunPending()) {
+                pool->SleepWhile(pending_);  // Разбудит новая задача или последняя задача группы.
+            }
+            continue;
+        }
+        std::unique_lock lock(mutex_);
+        if(pending_.load(std::memory_order_relaxed) == 0) {
+            break;
+        }
+        cv_.wait(lock);
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard lock(mutex_);  // См. mutex_: последняя задача отпустила группу.
+        error = std::exchange(error_, nullptr);
+    }
+    if(error) {
+        std::rethrow_exception(error);
+    }
+}
+
+}  // namespace dispatcher
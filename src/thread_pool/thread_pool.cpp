@@ -3,45 +3,372 @@
 #include <numeric>
 #include <algorithm>
 #include <print>
-#include <print>
+#include <stdexcept>
 
 namespace dispatcher::thread_pool {
 
-ThreadPool::ThreadPool(std::shared_ptr<queue::PriorityQueue> pq, size_t num_threads): pq_(pq) {
-    workers_.reserve(num_threads);
-    for(int i = 0; i < num_threads; ++i) {
-        workers_.emplace_back(&ThreadPool::Run, this);
+thread_local ThreadPool::Worker* ThreadPool::current_worker_ = nullptr;
+thread_local ThreadPool* ThreadPool::current_pool_            = nullptr;
+thread_local bool ThreadPool::retire_                         = false;
+
+ThreadPool::ThreadPool(std::shared_ptr<queue::PriorityQueue> pq, size_t num_threads, ThreadPoolOptions options):
+    pq_(pq),
+    options_(options) {
+    if(options_.work_stealing && options_.max_threads > num_threads) {
+        throw std::invalid_argument("Elastic thread pool is not supported with work stealing");
+    }
+    for(const auto& [priority, queue]: pq_->GetQueues()) {
+        priorities_.push_back(priority);
+    }
+    if(options_.placement != Placement::None) {
+        nodes_ = CpuTopology::Discover().nodes;
+    }
+    if(options_.work_stealing) {
+        const size_t levels = priorities_.empty() ? 0 : static_cast<size_t>(priorities_.back()) + 1;
+
+        states_.reserve(num_threads);
+        for(size_t i = 0; i < num_threads; ++i) {
+            auto worker   = std::make_unique<Worker>();
+            worker->pool  = this;
+            worker->index = i;
+            worker->local.resize(levels);
+            for(auto priority: priorities_) {
+                worker->local[static_cast<size_t>(priority)] = std::make_unique<WorkStealingDeque>();
+            }
+            states_.push_back(std::move(worker));
+        }
+        // Жертвы перебираются по кругу начиная со следующего воркера, чтобы воры не толпились у одной очереди.
+        for(auto& worker: states_) {
+            const size_t node = NodeOf(worker->index);
+            for(size_t i = 1; i < num_threads; ++i) {
+                auto* victim = states_[(worker->index + i) % num_threads].get();
+                if(NodeOf(victim->index) == node) {
+                    worker->victims.push_back(victim);
+                }
+            }
+            worker->near = worker->victims.size();
+            for(size_t i = 1; i < num_threads; ++i) {
+                auto* victim = states_[(worker->index + i) % num_threads].get();
+                if(NodeOf(victim->index) != node) {
+                    worker->victims.push_back(victim);
+                }
+            }
+        }
+    }
+
+    for(size_t i = 0; i < num_threads; ++i) {
+        Spawn(options_.work_stealing ? states_[i].get() : nullptr);
+    }
+    if(options_.max_threads > num_threads) {
+        supervisor_ = std::jthread([this, num_threads](std::stop_token stop) { Supervise(stop, num_threads); });
     }
 }
 
 ThreadPool::~ThreadPool() {
+    // Сперва останавливаем надзирателя: после этого список воркеров больше не меняется.
+    if(supervisor_.joinable()) {
+        supervisor_.request_stop();
+        supervisor_.join();
+    }
     // После вызова деструктора потоки должны исполнять задачи, пока из приоритетной очереди не вернется std::nullopt.
     if(pq_) {
         pq_->Shutdown();
     }
     for(auto& worker: workers_) {
-        if(worker.joinable()) {
-            worker.join();
+        if(worker.thread.joinable()) {
+            worker.thread.join();
+        }
+    }
+}
+
+void ThreadPool::Spawn(Worker* state) {
+    auto& slot = workers_.emplace_back();
+    thread_count_.fetch_add(1, std::memory_order_relaxed);
+    slot.thread = std::jthread([this, &slot, state, cpus = CpusOf(spawned_++)] {
+        if(!cpus.empty()) {
+            PinCurrentThread(cpus);
+        }
+        current_pool_ = this;
+        if(state) {
+            RunStealing(*state);
+        }
+        else if(options_.pop_batch > 1) {
+            RunBatched();
+        }
+        else {
+            Run();
+        }
+        current_pool_ = nullptr;
+        thread_count_.fetch_sub(1, std::memory_order_relaxed);
+        slot.finished.store(true, std::memory_order_release);
+    });
+}
+
+size_t ThreadPool::NodeOf(size_t index) const {
+    return nodes_.empty() ? 0 : index % nodes_.size();
+}
+
+std::vector<int> ThreadPool::CpusOf(size_t index) const {
+    if(nodes_.empty()) {
+        return {};
+    }
+    const auto& node = nodes_[NodeOf(index)];
+    if(options_.placement == Placement::Cpu) {
+        return {node[(index / nodes_.size()) % node.size()]};
+    }
+    return node;
+}
+
+void ThreadPool::Supervise(std::stop_token stop, size_t min_threads) {
+    using Clock = std::chrono::steady_clock;
+    std::optional<Clock::time_point> backlog_since;
+    std::optional<Clock::time_point> idle_since;
+
+    std::unique_lock lock(supervisor_mutex_);
+    while(true) {
+        supervisor_cv_.wait_for(lock, stop, options_.scale_interval, [] { return false; });
+        if(stop.stop_requested()) {
+            return;
+        }
+        Reap();
+
+        const auto now      = Clock::now();
+        const size_t depth  = pq_->Size();
+        const size_t asleep = pq_->Sleeping();
+        const size_t count  = thread_count_.load(std::memory_order_relaxed);
+
+        // Очередь растет, а все воркеры заняты: добавляем одного и снова ждем spawn_delay, прежде чем добавить еще.
+        if(depth > options_.spawn_depth && asleep == 0) {
+            backlog_since = backlog_since.value_or(now);
+            if(now - *backlog_since >= options_.spawn_delay && count < options_.max_threads) {
+                Spawn();
+                backlog_since.reset();
+            }
+        }
+        else {
+            backlog_since.reset();
+        }
+
+        // Воркеры простаивают: отпускаем по одному, пока простой продолжается. Отставка - задача самого низкого
+        // приоритета: ее выполнит один из спящих воркеров и выйдет из цикла.
+        if(depth == 0 && asleep > 0 && !priorities_.empty()) {
+            idle_since = idle_since.value_or(now);
+            const bool pending = retire_pending_.load(std::memory_order_acquire);
+            if(!pending && count > min_threads && now - *idle_since >= options_.idle_timeout) {
+                retire_pending_.store(true, std::memory_order_release);
+                Task retire = [this] {
+                    // Отставку мог выполнить и чужой поток (например, ждущий Future) - тогда она просто пропадает.
+                    retire_ = current_pool_ == this;
+                    retire_pending_.store(false, std::memory_order_release);
+                };
+                if(pq_->TryPush(priorities_.back(), retire) != queue::PushResult::Pushed) {
+                    retire_pending_.store(false, std::memory_order_release);
+                }
+            }
+        }
+        else {
+            idle_since.reset();
+        }
+    }
+}
+
+void ThreadPool::Reap() {
+    for(auto it = workers_.begin(); it != workers_.end();) {
+        if(it->finished.load(std::memory_order_acquire)) {
+            it->thread.join();
+            it = workers_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+bool ThreadPool::TryPushLocal(TaskPriority priority, Task& task) {
+    auto* self = current_worker_;
+    if(!options_.work_stealing || !self || self->pool != this) {
+        return false;
+    }
+    const auto level = static_cast<size_t>(priority);
+    if(level >= self->local.size() || !self->local[level]) {
+        return false;  // Такого приоритета нет - пусть PriorityQueue сообщит об ошибке.
+    }
+    // Если есть припаркованные воркеры, отдаем задачу через общую очередь - так она разбудит одного из них. Иначе все
+    // заняты, и задача дождется владельца или вора в локальной очереди без захвата общего мьютекса.
+    if(idle_.load(std::memory_order_seq_cst) > 0) {
+        return false;
+    }
+    self->local[level]->PushBottom(std::move(task));
+    return true;
+}
+
+bool ThreadPool::RunPending() {
+    if(!OnWorker()) {
+        return false;
+    }
+    std::optional<Task> task;
+    if(auto* self = current_worker_; self && self->pool == this) {
+        task = FindTask(*self);
+    }
+    else {
+        for(auto priority: priorities_) {
+            if((task = pq_->TryPop(priority))) {
+                break;
+            }
         }
     }
+    if(!task) {
+        return false;
+    }
+    Execute(*task);
+    return true;
+}
+
+void ThreadPool::SleepWhile(const std::atomic<size_t>& pending) {
+    auto* self = current_worker_;
+    if(!self || self->pool != this) {
+        pq_->SleepWhile(pending);
+        return;
+    }
+    // Как в RunStealing(): после регистрации соседи отдают задачи через общую очередь, и она нас разбудит, а задачу,
+    // оставленную в локальной очереди соседа до регистрации, находим перепроверкой.
+    idle_.fetch_add(1, std::memory_order_seq_cst);
+    auto task = FindTask(*self);
+    if(!task) {
+        pq_->SleepWhile(pending);
+    }
+    idle_.fetch_sub(1, std::memory_order_seq_cst);
+    if(task) {
+        Execute(*task);
+    }
 }
 
 void ThreadPool::Run() {
+    queue::SpinWait spin(options_.spin);
     while(true) {
-        auto task = pq_->Pop();  // NVRO
+        auto task = pq_->Pop(spin);  // NVRO
         if(!task) {
             return;  // Прекращаем работу после того, как получили команду Shutdown().
         }
-        // Так как задачи независимы, то нет смысла использовать примитивы синхронизации при выполнении задач.
-        try {
-            (*task)();
+        Execute(*task);
+        if(retire_) {
+            retire_ = false;
+            return;  // Надзиратель эластичного пула отпустил воркера.
+        }
+    }
+}
+
+void ThreadPool::RunBatched() {
+    std::vector<Task> batch(options_.pop_batch);
+    // С весами и старением PriorityQueue сама делит очередь между уровнями, и вытеснение пачки задачами выше по
+    // приоритету снова морило бы нижние уровни голодом.
+    const bool preempt = pq_->IsStrict();
+    queue::SpinWait spin(options_.spin);
+    while(true) {
+        const auto [priority, size] = pq_->PopBatch(batch, spin);
+        if(size == 0) {
+            return;  // Shutdown() и очереди пусты.
+        }
+        for(size_t i = 0; i < size; ++i) {
+            if(i > 0 && preempt) {
+                // Задачи пачки уже недоступны другим воркерам, поэтому инверсия приоритетов ограничена одной задачей:
+                // все, что успело прийти в более приоритетные очереди, выполняется раньше следующей задачи пачки.
+                RunHigher(priority);
+            }
+            Execute(batch[i]);
+            batch[i] = nullptr;  // Освобождаем захваченные задачей ресурсы, не дожидаясь конца пачки.
+        }
+        if(retire_) {
+            retire_ = false;
+            return;  // Задачи пачки уже выполнены.
+        }
+    }
+}
+
+void ThreadPool::RunHigher(TaskPriority priority) {
+    bool found = true;
+    while(found) {
+        found = false;
+        for(auto higher: priorities_) {
+            if(higher >= priority) {
+                break;
+            }
+            if(auto task = pq_->TryPop(higher)) {
+                Execute(*task);
+                found = true;
+                break;  // После каждой задачи снова начинаем с высшего приоритета.
+            }
+        }
+    }
+}
+
+void ThreadPool::RunStealing(Worker& self) {
+    current_worker_ = &self;
+    queue::SpinWait spin(options_.spin);
+    while(true) {
+        if(auto task = FindTask(self)) {
+            Execute(*task);
+            continue;
         }
-        catch(const std::exception& e) {
-            std::println("Exception thrown while running task: {}", e.what());
+
+        // Регистрируемся как простаивающий и перепроверяем: задача, положенная в локальную очередь до регистрации,
+        // будет найдена здесь, а после - уйдет в общую очередь (см. TryPushLocal()). Локальную очередь наполняет только
+        // ее владелец, и он не паркуется, пока она не пуста, поэтому задачи не теряются и при Shutdown().
+        idle_.fetch_add(1, std::memory_order_seq_cst);
+        auto task = FindTask(self);
+        if(!task) {
+            task = pq_->Pop(spin);
         }
-        catch(...) {
-            std::println("Unknown exception thrown while running task");
+        idle_.fetch_sub(1, std::memory_order_seq_cst);
+
+        if(!task) {
+            current_worker_ = nullptr;
+            return;
         }
+        Execute(*task);
+    }
+}
+
+std::optional<Task> ThreadPool::FindTask(Worker& self) {
+    // Приоритеты перебираются от высшего к низшему, и на каждом уровне проверяются все источники своего узла. Так
+    // задача High всегда берется раньше Normal, где бы она ни лежала: в своей очереди, в общей или у соседа по узлу.
+    for(auto priority: priorities_) {
+        const auto level = static_cast<size_t>(priority);
+        if(auto task = self.local[level]->PopBottom()) {
+            return task;
+        }
+        if(auto task = pq_->TryPop(priority)) {
+            return task;
+        }
+        for(size_t i = 0; i < self.near; ++i) {
+            if(auto task = self.victims[i]->local[level]->Steal()) {
+                return task;
+            }
+        }
+    }
+    // Задачи воркеров других узлов лежат в чужой памяти, поэтому их воруем, только когда своему узлу делать нечего. Без
+    // привязки узел один, и сюда никто не попадает.
+    for(auto priority: priorities_) {
+        const auto level = static_cast<size_t>(priority);
+        for(size_t i = self.near; i < self.victims.size(); ++i) {
+            if(auto task = self.victims[i]->local[level]->Steal()) {
+                return task;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+void ThreadPool::Execute(Task& task) {
+    // Так как задачи независимы, то нет смысла использовать примитивы синхронизации при выполнении задач.
+    try {
+        task();
+    }
+    catch(const std::exception& e) {
+        std::println("Exception thrown while running task: {}", e.what());
+    }
+    catch(...) {
+        std::println("Unknown exception thrown while running task");
     }
 }
 
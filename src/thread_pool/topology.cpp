@@ -0,0 +1,152 @@
+#include "thread_pool/topology.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace dispatcher::thread_pool {
+
+namespace {
+
+std::string_view Trim(std::string_view text) {
+    const auto first = text.find_first_not_of(" \t\n");
+    if(first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\n") - first + 1);
+}
+
+int ParseCpu(std::string_view text) {
+    int cpu          = 0;
+    const auto begin = text.data();
+    const auto end   = text.data() + text.size();
+
+    const auto [ptr, error] = std::from_chars(begin, end, cpu);
+    if(text.empty() || error != std::errc {} || ptr != end || cpu < 0) {
+        throw std::invalid_argument("Malformed CPU list");
+    }
+    return cpu;
+}
+
+// CPU, на которых процессу разрешено работать.
+std::vector<int> AllowedCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if(CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if(cpus.empty()) {
+        cpus.resize(std::max(std::thread::hardware_concurrency(), 1u));
+        for(size_t i = 0; i < cpus.size(); ++i) {
+            cpus[i] = static_cast<int>(i);
+        }
+    }
+    return cpus;
+}
+
+}  // namespace
+
+std::vector<int> CpuTopology::ParseCpuList(std::string_view list) {
+    std::vector<int> cpus;
+    list = Trim(list);
+    while(!list.empty()) {
+        const auto comma = list.find(',');
+        const auto range = Trim(list.substr(0, comma));
+        list             = comma == std::string_view::npos ? std::string_view {} : list.substr(comma + 1);
+
+        const auto dash  = range.find('-');
+        const int first  = ParseCpu(range.substr(0, dash));
+        const int last   = dash == std::string_view::npos ? first : ParseCpu(range.substr(dash + 1));
+        if(last < first) {
+            throw std::invalid_argument("Malformed CPU list");
+        }
+        for(int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    std::ranges::sort(cpus);
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+CpuTopology CpuTopology::Discover() {
+    const auto allowed = AllowedCpus();
+    CpuTopology topology;
+
+    // Узлы сортируем по номеру: порядок обхода каталога не определен.
+    std::vector<std::pair<int, std::vector<int>>> nodes;
+    std::error_code error;
+    for(const auto& entry: std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+        const auto name = entry.path().filename().string();
+        if(!name.starts_with("node")) {
+            continue;
+        }
+        int id           = 0;
+        const auto begin = name.data() + 4;
+        const auto end   = name.data() + name.size();
+        if(auto [ptr, code] = std::from_chars(begin, end, id); begin == end || code != std::errc {} || ptr != end) {
+            continue;
+        }
+        std::ifstream file(entry.path() / "cpulist");
+        const std::string list {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        std::vector<int> cpus;
+        try {
+            for(int cpu: ParseCpuList(list)) {
+                if(std::ranges::binary_search(allowed, cpu)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+        catch(const std::invalid_argument&) {
+            continue;
+        }
+        if(!cpus.empty()) {
+            nodes.emplace_back(id, std::move(cpus));
+        }
+    }
+    std::ranges::sort(nodes);
+    for(auto& [id, cpus]: nodes) {
+        topology.nodes.push_back(std::move(cpus));
+    }
+
+    if(topology.nodes.empty()) {
+        topology.nodes.push_back(allowed);
+    }
+    return topology;
+}
+
+bool PinCurrentThread(std::span<const int> cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(int cpu: cpus) {
+        if(cpu < 0 || cpu >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+    // Для sched_setaffinity() 0 - вызывающий поток, а не весь процесс.
+    return !cpus.empty() && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+}  // namespace dispatcher::thread_pool
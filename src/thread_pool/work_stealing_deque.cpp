@@ -0,0 +1,39 @@
+#include "thread_pool/work_stealing_deque.hpp"
+
+namespace dispatcher::thread_pool {
+
+void WorkStealingDeque::PushBottom(Task task) {
+    std::lock_guard lock(mutex_);
+    tasks_.push_back(std::move(task));
+    size_.store(tasks_.size(), std::memory_order_release);
+}
+
+std::optional<Task> WorkStealingDeque::PopBottom() {
+    if(Empty()) {
+        return std::nullopt;
+    }
+    std::lock_guard lock(mutex_);
+    if(tasks_.empty()) {
+        return std::nullopt;
+    }
+    auto task = std::move(tasks_.back());
+    tasks_.pop_back();
+    size_.store(tasks_.size(), std::memory_order_release);
+    return task;
+}
+
+std::optional<Task> WorkStealingDeque::Steal() {
+    if(Empty()) {
+        return std::nullopt;
+    }
+    std::unique_lock lock(mutex_, std::try_to_lock);  // Не толкаемся с владельцем: занято - идем к следующей жертве.
+    if(!lock.owns_lock() || tasks_.empty()) {
+        return std::nullopt;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    size_.store(tasks_.size(), std::memory_order_release);
+    return task;
+}
+
+}  // namespace dispatcher::thread_pool
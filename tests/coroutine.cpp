@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "coroutine.hpp"
+#include "task_dispatcher.hpp"
+
+using dispatcher::TaskDispatcher;
+using dispatcher::TaskPriority;
+using dispatcher::coro::SyncWait;
+using dispatcher::coro::WhenAll;
+
+template<typename T = void>
+using CoTask = dispatcher::coro::Task<T>;
+
+namespace {
+
+CoTask<int> Add(int a, int b) {
+    co_return a + b;
+}
+
+CoTask<int> Chain() {
+    const int first  = co_await Add(1, 2);
+    const int second = co_await Add(first, 10);
+    co_return second;
+}
+
+CoTask<> Fail() {
+    throw std::runtime_error("boom");
+    co_return;
+}
+
+CoTask<std::thread::id> WorkerId(TaskDispatcher& td, TaskPriority priority) {
+    co_await td.ScheduleOn(priority);
+    co_return std::this_thread::get_id();
+}
+
+CoTask<int> Square(TaskDispatcher& td, int value) {
+    co_await td.ScheduleOn(TaskPriority::Normal);
+    co_return value * value;
+}
+
+CoTask<> Count(TaskDispatcher& td, std::atomic<int>& counter) {
+    co_await td.ScheduleOn(TaskPriority::High);
+    counter++;
+}
+
+}  // namespace
+
+TEST(CoroutineTest, LazyTaskChainsResultsAndExceptions) {
+    auto task = Chain();
+    ASSERT_FALSE(task.IsReady());
+    ASSERT_EQ(SyncWait(std::move(task)), 13);
+    ASSERT_THROW(SyncWait(Fail()), std::runtime_error);
+}
+
+TEST(CoroutineTest, ScheduleOnResumesOnWorker) {
+    TaskDispatcher td(2);
+    const auto worker = SyncWait(WorkerId(td, TaskPriority::High));
+    ASSERT_NE(worker, std::this_thread::get_id());
+
+    auto future = td.Spawn(TaskPriority::Normal, Chain());
+    ASSERT_EQ(future.Get(), 13);
+    ASSERT_THROW(td.Spawn(TaskPriority::High, Fail()).Get(), std::runtime_error);
+}
+
+TEST(CoroutineTest, YieldLoopDoesNotGrowStack) {
+    TaskDispatcher td(2, dispatcher::init_config, {.work_stealing = true});
+    auto loop = [](TaskDispatcher& td) -> CoTask<int> {
+        int steps = 0;
+        for(int i = 0; i < 10000; ++i) {
+            co_await td.Yield(TaskPriority::Normal);
+            ++steps;
+        }
+        co_return steps;
+    };
+    ASSERT_EQ(td.Spawn(TaskPriority::Normal, loop(td)).Get(), 10000);
+}
+
+TEST(CoroutineTest, WhenAllFansOutAndIn) {
+    TaskDispatcher td(4);
+
+    std::vector<CoTask<int>> squares;
+    for(int i = 0; i < 100; ++i) {
+        squares.push_back(Square(td, i));
+    }
+    const auto results = SyncWait(WhenAll(std::move(squares)));
+    ASSERT_EQ(results.size(), 100);
+    for(int i = 0; i < 100; ++i) {
+        ASSERT_EQ(results[i], i * i);
+    }
+
+    std::atomic<int> counter = 0;
+    std::vector<CoTask<>> counters;
+    for(int i = 0; i < 50; ++i) {
+        counters.push_back(Count(td, counter));
+    }
+    SyncWait(WhenAll(std::move(counters)));
+    ASSERT_EQ(counter.load(), 50);
+
+    const auto [square, id, sum] = SyncWait(WhenAll(Square(td, 7), WorkerId(td, TaskPriority::High), Add(1, 1)));
+    ASSERT_EQ(square, 49);
+    ASSERT_NE(id, std::this_thread::get_id());
+    ASSERT_EQ(sum, 2);
+
+    auto mixed = WhenAll(Square(td, 3), Fail());
+    ASSERT_THROW(SyncWait(std::move(mixed)), std::runtime_error);
+    ASSERT_TRUE(SyncWait(WhenAll(std::vector<CoTask<int>> {})).empty());
+}
+
+TEST(CoroutineTest, RejectedContinuationThrowsInPlace) {
+    using dispatcher::queue::OverflowPolicy;
+    using dispatcher::queue::QueueOptions;
+    const std::map<TaskPriority, QueueOptions> config = {
+        {TaskPriority::High, QueueOptions {.bounded = true, .capacity = 1, .overflow = OverflowPolicy::Reject}}};
+    TaskDispatcher td(1, config);
+
+    std::promise<void> release;
+    std::promise<void> started;
+    td.Schedule(TaskPriority::High, [&started, gate = release.get_future().share()] {
+        started.set_value();
+        gate.wait();
+    });
+    started.get_future().wait();
+    td.Schedule(TaskPriority::High, [] {});  // Очередь заполнена.
+
+    ASSERT_THROW(SyncWait(WorkerId(td, TaskPriority::High)), std::runtime_error);
+    release.set_value();
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "future.hpp"
+#include "task.hpp"
+
+using dispatcher::Future;
+using dispatcher::Promise;
+using dispatcher::Task;
+
+TEST(FutureTest, GetReturnsValueSetFromAnotherThread) {
+    Promise<std::string> promise;
+    auto future = promise.GetFuture();
+    ASSERT_FALSE(future.IsReady());
+
+    std::jthread producer([promise = std::move(promise)]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        promise.SetValue("done");
+    });
+
+    ASSERT_EQ(future.Get(), "done");
+    ASSERT_FALSE(future.Valid());
+}
+
+TEST(FutureTest, FulfillStoresException) {
+    Promise<int> promise;
+    auto future = promise.GetFuture();
+
+    auto f = []() -> int { throw std::runtime_error("boom"); };
+    promise.Fulfill(f);
+
+    ASSERT_TRUE(future.IsReady());
+    ASSERT_THROW(future.Get(), std::runtime_error);
+}
+
+TEST(FutureTest, VoidAndMoveOnlyResults) {
+    Promise<void> done;
+    auto done_future = done.GetFuture();
+    auto noop        = [] {};
+    done.Fulfill(noop);
+    done_future.Get();
+
+    Promise<std::unique_ptr<int>> boxed;
+    auto boxed_future = boxed.GetFuture();
+    boxed.SetValue(std::make_unique<int>(7));
+    ASSERT_EQ(*boxed_future.Get(), 7);
+}
+
+TEST(FutureTest, InvalidFutureReportsNoState) {
+    Future<int> empty;
+    ASSERT_FALSE(empty.Valid());
+    ASSERT_THROW(empty.IsReady(), std::future_error);
+    ASSERT_THROW(empty.Wait(), std::future_error);
+    ASSERT_THROW(empty.Get(), std::future_error);
+
+    Promise<int> promise;
+    auto future = promise.GetFuture();
+    promise.SetValue(1);
+    ASSERT_EQ(future.Get(), 1);
+    ASSERT_THROW(future.IsReady(), std::future_error);  // После Get() состояние забрано.
+}
+
+TEST(FutureTest, BrokenPromiseIfTaskDropped) {
+    Future<int> future;
+    {
+        Promise<int> promise;
+        future = promise.GetFuture();
+        Task task = [promise = std::move(promise)]() mutable { promise.SetValue(1); };
+    }  // Задача разрушена, так и не будучи выполненной.
+
+    try {
+        future.Get();
+        FAIL() << "Expected broken_promise";
+    }
+    catch(const std::future_error& e) {
+        ASSERT_EQ(e.code(), std::future_errc::broken_promise);
+    }
+}
+
+TEST(FutureTest, PromiseAndCallableFitInTaskBuffer) {
+    auto lambda = [promise = Promise<int>(), a = 1, b = 2]() mutable { promise.SetValue(a + b); };
+    ASSERT_TRUE(Task::IsInline<decltype(lambda)>());
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "logger.hpp"
+
+namespace {
+
+std::vector<std::string> ReadLines(FILE* file) {
+    fflush(file);
+    rewind(file);
+    std::string text;
+    char chunk[4096];
+    while(size_t size = fread(chunk, 1, sizeof(chunk), file)) {
+        text.append(chunk, size);
+    }
+    std::vector<std::string> lines;
+    std::istringstream stream(text);
+    for(std::string line; std::getline(stream, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+}  // namespace
+
+TEST(LoggerTest, SyncModeFormatsMessages) {
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+    {
+        Logger logger(file);
+        logger.Log("plain {}");
+        logger.Log("message #{} of {}", 1, std::string("two"));
+        logger.Log(std::string(2000, 'x') + "{}");
+    }
+    const auto lines = ReadLines(file);
+    ASSERT_EQ(lines.size(), 3);
+    ASSERT_EQ(lines[0], "plain {}");
+    ASSERT_EQ(lines[1], "message #1 of two");
+    ASSERT_EQ(lines[2].size(), 2002);
+    fclose(file);
+}
+
+TEST(LoggerTest, AsyncModeKeepsPerThreadOrder) {
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+    constexpr int kThreads  = 4;
+    constexpr int kMessages = 2000;
+    {
+        // Маленький буфер: потокам приходится ждать сброса, а сообщения переходят через край кольца.
+        Logger logger(file, {.async = true, .buffer_size = 256});
+        std::vector<std::jthread> threads;
+        for(int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&logger, t] {
+                for(int i = 0; i < kMessages; ++i) {
+                    logger.Log("{} {}", t, i);
+                }
+            });
+        }
+    }
+    std::vector<int> next(kThreads, 0);
+    for(const auto& line: ReadLines(file)) {
+        int thread = 0;
+        int index  = 0;
+        ASSERT_EQ(sscanf(line.c_str(), "%d %d", &thread, &index), 2) << line;
+        ASSERT_EQ(index, next[thread]++);
+    }
+    for(int t = 0; t < kThreads; ++t) {
+        ASSERT_EQ(next[t], kMessages);
+    }
+    fclose(file);
+}
+
+TEST(LoggerTest, AsyncFlushWritesEverythingLoggedBefore) {
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+    Logger logger(file, {.async = true, .buffer_size = 64, .flush_interval = std::chrono::milliseconds(60000)});
+    logger.Log("first");
+    logger.Log(std::string(1000, 'y'));  // Больше буфера: пишется напрямую, но после first.
+    logger.Log("third {}", 3);
+    logger.Flush();
+
+    const auto lines = ReadLines(file);
+    ASSERT_EQ(lines.size(), 3);
+    ASSERT_EQ(lines[0], "first");
+    ASSERT_EQ(lines[1], std::string(1000, 'y'));
+    ASSERT_EQ(lines[2], "third 3");
+
+    ASSERT_THROW(Logger(file, {.buffer_size = 0}), std::invalid_argument);
+    fclose(file);
+}
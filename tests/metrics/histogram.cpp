@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "metrics/histogram.hpp"
+
+using dispatcher::metrics::HistogramSnapshot;
+using dispatcher::metrics::LatencyHistogram;
+
+TEST(LatencyHistogramTest, BucketsCoverRangeWithBoundedError) {
+    for(uint64_t value: {uint64_t {0}, uint64_t {7}, uint64_t {8}, uint64_t {1000}, uint64_t {123456789}, UINT64_MAX}) {
+        const auto index = LatencyHistogram::BucketIndex(value);
+        ASSERT_LT(index, LatencyHistogram::kBuckets);
+        const auto lower = LatencyHistogram::BucketLowerBound(index);
+        ASSERT_LE(lower, value);
+        // Ширина корзины - не больше 1 / kSubBuckets от ее нижней границы.
+        ASSERT_LE(value - lower, lower / LatencyHistogram::kSubBuckets);
+    }
+}
+
+TEST(LatencyHistogramTest, PercentilesAndMean) {
+    LatencyHistogram histogram;
+    for(uint64_t value = 1; value <= 100; ++value) {
+        histogram.Record(value * 1000);
+    }
+
+    HistogramSnapshot snapshot;
+    histogram.AddTo(snapshot);
+    ASSERT_EQ(snapshot.count, 100);
+    ASSERT_EQ(snapshot.max, 100'000);
+    ASSERT_DOUBLE_EQ(snapshot.Mean(), 50'500.0);
+
+    const auto p50 = snapshot.Percentile(0.5);
+    ASSERT_GE(p50, 50'000);
+    ASSERT_LE(p50, 50'000 + 50'000 / LatencyHistogram::kSubBuckets);
+    ASSERT_EQ(snapshot.Percentile(1.0), 100'000);
+    ASSERT_EQ(HistogramSnapshot {}.Percentile(0.99), 0);
+}
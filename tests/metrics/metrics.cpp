@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <stdexcept>
+#include <thread>
+
+#include "metrics/metrics.hpp"
+
+using dispatcher::Task;
+using dispatcher::TaskPriority;
+using dispatcher::metrics::Metrics;
+
+TEST(MetricsTest, CountsPerLevelAndPerThread) {
+    const std::array priorities {TaskPriority::Normal, TaskPriority::High};
+    Metrics metrics(priorities);
+
+    auto ok     = metrics.Instrument(TaskPriority::High, [] {});
+    auto failed = metrics.Instrument(TaskPriority::Normal, [] { throw std::runtime_error("boom"); });
+    auto queued = metrics.Instrument(TaskPriority::Normal, [] {});
+
+    std::jthread([&] {
+        ok();
+        ASSERT_THROW(failed(), std::runtime_error);  // Исключение проходит сквозь обертку к воркеру.
+    }).join();
+
+    auto snapshot = metrics.Collect();
+    ASSERT_EQ(snapshot.levels.size(), 2);
+
+    const auto& high = snapshot.levels[0];
+    ASSERT_EQ(high.priority, TaskPriority::High);
+    ASSERT_EQ(high.enqueued, 1);
+    ASSERT_EQ(high.completed, 1);
+    ASSERT_EQ(high.depth, 0);
+    ASSERT_EQ(high.wait.count, 1);
+    ASSERT_EQ(high.run.count, 1);
+
+    const auto& normal = snapshot.levels[1];
+    ASSERT_EQ(normal.enqueued, 2);
+    ASSERT_EQ(normal.failed, 1);
+    ASSERT_EQ(normal.completed, 0);
+    ASSERT_EQ(normal.depth, 1);  // queued еще не выполнялась.
+
+    ASSERT_EQ(snapshot.workers.size(), 1);
+    ASSERT_EQ(snapshot.workers[0].executed, 2);
+}
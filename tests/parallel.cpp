@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <ranges>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "task_dispatcher.hpp"
+
+using dispatcher::TaskDispatcher;
+using dispatcher::TaskPriority;
+
+TEST(ParallelTest, ForVisitsEveryElementOnceAndUsesWorkers) {
+    TaskDispatcher td(4);
+    constexpr size_t kSize = 1 << 14;
+    std::vector<std::atomic<int>> visits(kSize);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+
+    td.ParallelFor(std::views::iota(size_t {0}, kSize), 64, [&](size_t i) {
+        visits[i].fetch_add(1, std::memory_order_relaxed);
+        if(i % 64 == 0) {
+            std::lock_guard lock(mutex);
+            threads.insert(std::this_thread::get_id());
+            // Без паузы на одном ядре вызывающий поток успел бы выполнить весь цикл, прежде чем воркеры получат время.
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    for(const auto& count: visits) {
+        ASSERT_EQ(count.load(), 1);
+    }
+    ASSERT_GT(threads.size(), 1);  // Цикл разделился: часть итераций выполнили воркеры.
+}
+
+TEST(ParallelTest, ReduceMatchesSequentialResult) {
+    TaskDispatcher td(4);
+    std::vector<uint64_t> values(100000);
+    std::iota(values.begin(), values.end(), uint64_t {1});
+
+    const auto sum = td.ParallelReduce(values, 256, uint64_t {7}, std::plus<> {});
+    ASSERT_EQ(sum, 7 + values.size() * (values.size() + 1) / 2);
+
+    const auto squares = td.ParallelReduce(values, 1000, uint64_t {0}, std::plus<> {}, [](uint64_t x) { return x * x; },
+                                           TaskPriority::High);
+    uint64_t expected = 0;
+    for(auto x: values) {
+        expected += x * x;
+    }
+    ASSERT_EQ(squares, expected);
+
+    const std::vector<std::string> empty;
+    ASSERT_EQ(td.ParallelReduce(empty, 1, std::string("init"), std::plus<> {}), "init");
+}
+
+TEST(ParallelTest, NestedLoopsInsideWorkersComplete) {
+    // Внешний цикл выполняется воркерами, и каждый из них запускает внутренний: вызывающий поток выполняет итерации
+    // сам, поэтому занятые воркеры не ждут друг друга.
+    TaskDispatcher td(2);
+    std::atomic<size_t> total {0};
+    td.ParallelFor(std::views::iota(0, 16), 1, [&](int) {
+        td.ParallelFor(std::views::iota(0, 1000), 10, [&](int) { total.fetch_add(1, std::memory_order_relaxed); });
+    });
+    ASSERT_EQ(total.load(), 16000);
+}
+
+TEST(ParallelTest, ExceptionStopsLoopAndReachesCaller) {
+    TaskDispatcher td(4);
+    std::atomic<size_t> done {0};
+    auto body = [&](size_t i) {
+        if(i == 1000) {
+            throw std::runtime_error("iteration failed");
+        }
+        done.fetch_add(1, std::memory_order_relaxed);
+    };
+    ASSERT_THROW(td.ParallelFor(std::views::iota(size_t {0}, size_t {1} << 20), 16, body), std::runtime_error);
+    ASSERT_LT(done.load(), size_t {1} << 20);
+
+    ASSERT_THROW(td.ParallelFor(std::views::iota(0, 10), 0, [](int) {}), std::invalid_argument);
+    ASSERT_THROW(td.ParallelFor(std::views::iota(0, 10), 1, [](int) {}, dispatcher::PriorityLevel(5)),
+                 std::invalid_argument);
+}
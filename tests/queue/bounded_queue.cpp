@@ -118,3 +118,116 @@ TEST(BoundedQueueTest, MultiProducerMultiConsumer) {
 
     EXPECT_EQ(counter.load(), 100);
 }
+
+TEST(BoundedQueueTest, PushBatchFitsInOneGo) {
+    BoundedQueue q(4);
+    std::vector<int> order;
+
+    std::vector<Task> batch;
+    for(int i = 0; i < 4; ++i) {
+        batch.emplace_back([&order, i] { order.push_back(i); });
+    }
+    ASSERT_EQ(q.PushBatch(batch), 4);
+
+    while(auto task = q.TryPop()) {
+        (*task)();
+    }
+    ASSERT_EQ(order, (std::vector<int> {0, 1, 2, 3}));
+}
+
+TEST(BoundedQueueTest, PushBatchBlocksOnlyForMissingSpace) {
+    BoundedQueue q(2);
+    std::atomic<int> counter = 0;
+
+    std::vector<Task> batch;
+    for(int i = 0; i < 5; ++i) {
+        batch.emplace_back([&] { counter++; });
+    }
+
+    auto fut = std::async(std::launch::async, [&] {
+        std::span<Task> rest(batch);
+        while(!rest.empty()) {
+            rest = rest.subspan(q.PushBatch(rest));
+        }
+    });
+
+    // Влезли только две задачи - производитель ждет места для оставшихся.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+
+    for(int i = 0; i < 5; ++i) {
+        auto task = q.Pop();
+        ASSERT_TRUE(task.has_value());
+        (*task)();
+    }
+
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(200)), std::future_status::ready);
+    ASSERT_EQ(counter.load(), 5);
+}
+
+TEST(BoundedQueueTest, PushBatchTakesOnlyFreeSpace) {
+    BoundedQueue q(3);
+    q.Push([] {});
+
+    std::vector<Task> batch(4);
+    for(auto& task: batch) {
+        task = [] {};
+    }
+
+    ASSERT_EQ(q.PushBatch(batch), 2);  // Свободно два слота - остальное остается у вызывающего.
+    ASSERT_FALSE(static_cast<bool>(batch[0]));
+    ASSERT_TRUE(static_cast<bool>(batch[2]));
+}
+
+TEST(BoundedQueueTest, TryPopBatchFreesSpaceForProducers) {
+    BoundedQueue q(3);
+    std::vector<int> order;
+    for(int i = 0; i < 3; ++i) {
+        q.Push([&order, i] { order.push_back(i); });
+    }
+
+    auto fut = std::async(std::launch::async, [&] { q.Push([&order] { order.push_back(3); }); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+
+    std::vector<Task> out(2);
+    ASSERT_EQ(q.TryPopBatch(out), 2);
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(200)), std::future_status::ready);
+
+    for(auto& task: out) {
+        task();
+    }
+    while(auto task = q.TryPop()) {
+        (*task)();
+    }
+    ASSERT_EQ(order, (std::vector<int> {0, 1, 2, 3}));
+}
+
+TEST(BoundedQueueTest, TryPushAndPushForLeaveTaskWhenFull) {
+    BoundedQueue q(1);
+    Task first = [] {};
+    ASSERT_TRUE(q.TryPush(first));
+    ASSERT_FALSE(static_cast<bool>(first));
+
+    Task second = [] {};
+    ASSERT_FALSE(q.TryPush(second));
+    ASSERT_FALSE(q.PushFor(second, std::chrono::milliseconds(20)));
+    ASSERT_TRUE(static_cast<bool>(second));  // Задача не принята и осталась у вызывающего.
+
+    q.TryPop();
+    ASSERT_TRUE(q.PushFor(second, std::chrono::milliseconds(20)));
+}
+
+TEST(BoundedQueueTest, PushDropOldestEvictsFront) {
+    BoundedQueue q(2);
+    std::vector<int> order;
+    for(int i = 0; i < 2; ++i) {
+        q.Push([&order, i] { order.push_back(i); });
+    }
+
+    ASSERT_EQ(q.PushDropOldest([&order] { order.push_back(2); }), 1);
+    while(auto task = q.TryPop()) {
+        (*task)();
+    }
+    ASSERT_EQ(order, (std::vector<int> {1, 2}));
+}
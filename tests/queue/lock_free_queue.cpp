@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <future>
+#include <chrono>
+
+#include "queue/lock_free_queue.hpp"
+#include "queue/priority_queue.hpp"
+
+using namespace dispatcher;
+using namespace dispatcher::queue;
+
+TEST(LockFreeQueueTest, PushPopFIFO) {
+    LockFreeQueue q(3);
+    std::vector<int> order;
+
+    q.Push([&] { order.push_back(1); });
+    q.Push([&] { order.push_back(2); });
+    q.Push([&] { order.push_back(3); });
+
+    for(int i = 0; i < 3; ++i) {
+        auto task = q.Pop();
+        ASSERT_TRUE(task.has_value());
+        (*task)();
+    }
+
+    ASSERT_EQ(order, (std::vector<int> {1, 2, 3}));
+}
+
+TEST(LockFreeQueueTest, TryPushFailsWhenFull) {
+    LockFreeQueue q(2);
+
+    Task task = [] {};
+    ASSERT_TRUE(q.TryPush(task));
+    task = [] {};
+    ASSERT_TRUE(q.TryPush(task));
+
+    task = [] {};
+    ASSERT_FALSE(q.TryPush(task));
+    ASSERT_TRUE(static_cast<bool>(task));  // Неудачная вставка не забирает задачу.
+
+    ASSERT_TRUE(q.TryPop().has_value());
+    ASSERT_TRUE(q.TryPush(task));
+}
+
+TEST(LockFreeQueueTest, TryPopReturnsEmptyWhenQueueEmpty) {
+    LockFreeQueue q(2);
+
+    ASSERT_FALSE(q.TryPop().has_value());
+}
+
+TEST(LockFreeQueueTest, ZeroCapacityThrows) {
+    ASSERT_THROW(LockFreeQueue q(0), std::invalid_argument);
+}
+
+TEST(LockFreeQueueTest, PushBlocksWhenFull) {
+    LockFreeQueue q(1);
+
+    q.Push([] {});
+
+    auto fut = std::async(std::launch::async, [&] {
+        q.Push([] {});
+        return true;
+    });
+
+    // Кольцо заполнено - производитель должен припарковаться.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(fut.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+
+    // TryPop() освобождает слот и будит производителя.
+    ASSERT_TRUE(q.TryPop().has_value());
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(200)), std::future_status::ready);
+}
+
+TEST(LockFreeQueueTest, PopBlocksUntilItemArrives) {
+    LockFreeQueue q(2);
+
+    auto fut = std::async(std::launch::async, [&] { return q.Pop().has_value(); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+
+    q.Push([] {});
+
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(200)), std::future_status::ready);
+    ASSERT_TRUE(fut.get());
+}
+
+TEST(LockFreeQueueTest, MultiProducerMultiConsumer) {
+    LockFreeQueue q(8);
+    static constexpr int N = 10000;
+
+    std::atomic<int> counter = 0;
+
+    auto producer = [&] {
+        for(int n = N; n-- > 0;) {
+            q.Push([&] { counter++; });
+        }
+    };
+
+    auto consumer = [&] {
+        for(int n = N; n-- > 0;) {
+            auto task = q.Pop();
+            ASSERT_TRUE(task.has_value());
+            (*task)();
+        }
+    };
+
+    {
+        std::jthread p1(producer);
+        std::jthread p2(producer);
+        std::jthread p3(producer);
+        std::jthread c1(consumer);
+        std::jthread c2(consumer);
+        std::jthread c3(consumer);
+    }
+
+    EXPECT_EQ(counter.load(), 3 * N);
+}
+
+TEST(LockFreeQueueTest, SelectedThroughQueueOptions) {
+    const std::map<TaskPriority, QueueOptions> config = {
+        {TaskPriority::High, QueueOptions {true, 16, true}},
+        {TaskPriority::Normal, QueueOptions {false, std::nullopt}}};
+
+    PriorityQueue pq(config);
+
+    auto high = pq.GetQueues().find(TaskPriority::High);
+    ASSERT_NE(high, pq.GetQueues().end());
+    ASSERT_NE(dynamic_cast<LockFreeQueue*>(high->second.get()), nullptr);
+
+    const std::map<TaskPriority, QueueOptions> unbounded = {
+        {TaskPriority::Normal, QueueOptions {false, std::nullopt, true}}};
+    ASSERT_THROW(PriorityQueue {unbounded}, std::invalid_argument);
+}
+
+TEST(LockFreeQueueTest, PushBatchBlocksOnlyForMissingSpace) {
+    LockFreeQueue q(2);
+    std::atomic<int> counter = 0;
+
+    std::vector<Task> batch;
+    for(int i = 0; i < 5; ++i) {
+        batch.emplace_back([&] { counter++; });
+    }
+
+    auto fut = std::async(std::launch::async, [&] {
+        std::span<Task> rest(batch);
+        while(!rest.empty()) {
+            rest = rest.subspan(q.PushBatch(rest));
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+
+    for(int i = 0; i < 5; ++i) {
+        auto task = q.Pop();
+        ASSERT_TRUE(task.has_value());
+        (*task)();
+    }
+
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(200)), std::future_status::ready);
+    ASSERT_EQ(counter.load(), 5);
+}
+
+TEST(LockFreeQueueTest, TryPopBatchKeepsOrder) {
+    LockFreeQueue q(4);
+    std::vector<int> order;
+    for(int i = 0; i < 3; ++i) {
+        q.Push([&order, i] { order.push_back(i); });
+    }
+
+    std::vector<Task> out(4);
+    ASSERT_EQ(q.TryPopBatch(out), 3);
+    for(auto& task: out | std::views::take(3)) {
+        task();
+    }
+    ASSERT_EQ(order, (std::vector<int> {0, 1, 2}));
+}
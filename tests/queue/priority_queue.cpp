@@ -1,7 +1,10 @@
 #include "queue/priority_queue.hpp"
 
 #include <gtest/gtest.h>
+#include <array>
+#include <atomic>
 #include <thread>
+#include <vector>
 #include <future>
 #include <chrono>
 
@@ -191,3 +194,349 @@ TEST_F(MyPriorityQueueTest, PopAfterShutdownAndEmptyQueuesReturnsNulloptImmediat
     auto task = pq->Pop();
     ASSERT_FALSE(task.has_value());
 }
+
+TEST_F(MyPriorityQueueTest, PushBatchWakesSleepingConsumers) {
+    std::atomic<int> executed = 0;
+
+    auto consumer = [&] {
+        while(auto task = pq->Pop()) {
+            (*task)();
+        }
+    };
+
+    std::thread c1(consumer);
+    std::thread c2(consumer);
+    std::this_thread::sleep_for(SHORT);
+
+    std::vector<Task> batch;
+    for(int i = 0; i < 10; ++i) {
+        batch.emplace_back([&] { executed++; });
+    }
+    pq->PushBatch(TaskPriority::High, batch);
+
+    std::this_thread::sleep_for(SHORT);
+    pq->Shutdown();
+    c1.join();
+    c2.join();
+
+    ASSERT_EQ(executed.load(), 10);
+}
+
+TEST_F(MyPriorityQueueTest, PushBatchThrowsForMissingPriorityQueue) {
+    const std::map<TaskPriority, QueueOptions> config = {{TaskPriority::High, QueueOptions {true, 10}}};
+    PriorityQueue pq(config);
+
+    std::vector<Task> batch;
+    batch.emplace_back([] {});
+    ASSERT_THROW(pq.PushBatch(TaskPriority::Normal, batch), std::invalid_argument);
+}
+
+TEST_F(MyPriorityQueueTest, PopBatchTakesFromHighestNonEmptyQueue) {
+    for(int i = 0; i < 3; ++i) {
+        pq->Push(TaskPriority::Normal, [] {});
+    }
+    pq->Push(TaskPriority::High, [] {});
+
+    std::vector<Task> out(8);
+    auto batch = pq->PopBatch(out);
+    ASSERT_EQ(batch.priority, TaskPriority::High);  // Задача High не смешивается с Normal в одной пачке.
+    ASSERT_EQ(batch.size, 1);
+
+    batch = pq->PopBatch(std::span(out).first(2));
+    ASSERT_EQ(batch.priority, TaskPriority::Normal);
+    ASSERT_EQ(batch.size, 2);
+
+    pq->Shutdown();
+    ASSERT_EQ(pq->PopBatch(out).size, 1);  // Задачи, положенные до Shutdown(), все равно отдаются.
+    ASSERT_EQ(pq->PopBatch(out).size, 0);
+}
+
+TEST_F(MyPriorityQueueTest, ArbitraryPriorityLevelsPoppedInOrder) {
+    const auto low    = PriorityLevel(2);
+    const auto lowest = PriorityLevel(kMaxPriorityLevels - 1);
+    const std::map<TaskPriority, QueueOptions> config = {{TaskPriority::High, QueueOptions {true, 10}},
+                                                         {TaskPriority::Normal, QueueOptions {false, std::nullopt}},
+                                                         {low, QueueOptions {false, std::nullopt}},
+                                                         {lowest, QueueOptions {true, 10, true}}};
+    PriorityQueue pq(config);
+    std::vector<std::string> order;
+
+    pq.Push(lowest, [&] { order.push_back("L63"); });
+    pq.Push(low, [&] { order.push_back("L2"); });
+    pq.Push(TaskPriority::Normal, [&] { order.push_back("N"); });
+    pq.Push(TaskPriority::High, [&] { order.push_back("H"); });
+    pq.Shutdown();
+
+    while(auto task = pq.Pop()) {
+        (*task)();
+    }
+    ASSERT_EQ(order, (std::vector<std::string> {"H", "N", "L2", "L63"}));
+}
+
+TEST_F(MyPriorityQueueTest, OutOfRangePriorityRejected) {
+    const std::map<TaskPriority, QueueOptions> config = {
+        {PriorityLevel(kMaxPriorityLevels), QueueOptions {false, std::nullopt}}};
+    ASSERT_THROW(PriorityQueue {config}, std::invalid_argument);
+
+    ASSERT_THROW(pq->Push(PriorityLevel(kMaxPriorityLevels), [] {}), std::invalid_argument);
+    ASSERT_FALSE(pq->TryPop(PriorityLevel(5)).has_value());
+
+    ASSERT_TRUE(pq->HasLevel(TaskPriority::High));
+    ASSERT_FALSE(pq->HasLevel(PriorityLevel(5)));
+    ASSERT_FALSE(pq->HasLevel(PriorityLevel(kMaxPriorityLevels)));
+}
+
+TEST_F(MyPriorityQueueTest, WeightedRoundRobinServesLowerLevels) {
+    const std::map<TaskPriority, QueueOptions> config = {
+        {TaskPriority::High, QueueOptions {.bounded = false, .weight = 3}},
+        {TaskPriority::Normal, QueueOptions {.bounded = false, .weight = 1}}};
+    PriorityQueue pq(config);
+    ASSERT_FALSE(pq.IsStrict());
+    std::string order;
+
+    for(int i = 0; i < 6; ++i) {
+        pq.Push(TaskPriority::High, [&] { order += 'H'; });
+    }
+    for(int i = 0; i < 3; ++i) {
+        pq.Push(TaskPriority::Normal, [&] { order += 'N'; });
+    }
+    pq.Shutdown();
+
+    while(auto task = pq.Pop()) {
+        (*task)();
+    }
+    ASSERT_EQ(order, "HHHNHHHNN");  // За раунд High отдает три задачи, Normal - одну.
+}
+
+TEST_F(MyPriorityQueueTest, AgingPromotesStarvedLevel) {
+    const std::map<TaskPriority, QueueOptions> config = {
+        {TaskPriority::High, QueueOptions {.bounded = false}},
+        {TaskPriority::Normal, QueueOptions {.bounded = false, .aging = 2}}};
+    PriorityQueue pq(config);
+    std::string order;
+
+    for(int i = 0; i < 5; ++i) {
+        pq.Push(TaskPriority::High, [&] { order += 'H'; });
+    }
+    for(int i = 0; i < 2; ++i) {
+        pq.Push(TaskPriority::Normal, [&] { order += 'N'; });
+    }
+    pq.Shutdown();
+
+    while(auto task = pq.Pop()) {
+        (*task)();
+    }
+    ASSERT_EQ(order, "HHNHHNH");  // Normal обходят не больше двух решений подряд.
+}
+
+TEST_F(MyPriorityQueueTest, OverflowPolicies) {
+    const std::map<TaskPriority, QueueOptions> config = {
+        {TaskPriority::High, QueueOptions {.bounded = true, .capacity = 1, .overflow = OverflowPolicy::Spill}},
+        {TaskPriority::Normal, QueueOptions {.bounded = true, .capacity = 1, .overflow = OverflowPolicy::Reject}},
+        {PriorityLevel(2), QueueOptions {.bounded = true, .capacity = 1, .overflow = OverflowPolicy::DropOldest}}};
+    PriorityQueue pq(config);
+
+    ASSERT_EQ(pq.Push(TaskPriority::High, [] {}), PushResult::Pushed);
+    ASSERT_EQ(pq.Push(TaskPriority::High, [] {}), PushResult::Spilled);  // Ушла в Normal.
+    ASSERT_EQ(pq.Push(TaskPriority::Normal, [] {}), PushResult::Rejected);
+    ASSERT_EQ(pq.Push(TaskPriority::High, [] {}), PushResult::Spilled);  // Normal полон - ушла на уровень 2.
+
+    std::string order;
+    size_t dropped = 0;
+    ASSERT_EQ(pq.Push(PriorityLevel(2), [&] { order += "new"; }, &dropped), PushResult::DroppedOldest);
+    ASSERT_EQ(dropped, 1);
+
+    const auto high = pq.GetOverflowStats(TaskPriority::High);
+    ASSERT_EQ(high.spilled, 2);
+    ASSERT_EQ(pq.GetOverflowStats(TaskPriority::Normal).rejected, 1);
+    ASSERT_EQ(pq.GetOverflowStats(PriorityLevel(2)).dropped_oldest, 1);
+
+    ASSERT_TRUE(pq.TryPop(TaskPriority::High).has_value());
+    ASSERT_TRUE(pq.TryPop(TaskPriority::Normal).has_value());
+    (*pq.TryPop(PriorityLevel(2)))();
+    ASSERT_EQ(order, "new");
+}
+
+TEST_F(MyPriorityQueueTest, TryPushAndPushForUnderBlockPolicy) {
+    const std::map<TaskPriority, QueueOptions> config = {{TaskPriority::High, QueueOptions {true, 1}}};
+    PriorityQueue pq(config);
+    pq.Push(TaskPriority::High, [] {});
+
+    Task task = [] {};
+    ASSERT_EQ(pq.TryPush(TaskPriority::High, task), PushResult::Rejected);
+    ASSERT_EQ(pq.PushFor(TaskPriority::High, task, SHORT), PushResult::TimedOut);
+    ASSERT_TRUE(static_cast<bool>(task));
+
+    auto stats = pq.GetOverflowStats(TaskPriority::High);
+    ASSERT_EQ(stats.rejected, 1);
+    ASSERT_EQ(stats.blocked, 1);
+    ASSERT_EQ(stats.timed_out, 1);
+
+    const std::map<TaskPriority, QueueOptions> no_lower = {
+        {TaskPriority::High, QueueOptions {.bounded = true, .capacity = 1, .overflow = OverflowPolicy::Spill}}};
+    ASSERT_THROW(PriorityQueue {no_lower}, std::invalid_argument);
+}
+
+TEST_F(MyPriorityQueueTest, DelayedAndPeriodicTasks) {
+    std::atomic<int> delayed = 0;
+    std::atomic<int> ticks   = 0;
+    const auto start         = std::chrono::steady_clock::now();
+    pq->ScheduleAfter(SHORT, TaskPriority::Normal, [&] { delayed++; });
+    const TimerId cancelled = pq->ScheduleAfter(SHORT, TaskPriority::High, [&] { delayed += 100; });
+    const TimerId periodic  = pq->ScheduleEvery(std::chrono::milliseconds(5), TaskPriority::High, [&] { ticks++; });
+    ASSERT_TRUE(pq->CancelTimer(cancelled));
+    ASSERT_FALSE(pq->CancelTimer(cancelled));
+
+    // Pop() спит до срока ближайшего таймера и сам переносит сработавшие задачи в очереди.
+    while(delayed.load() == 0) {
+        auto task = pq->Pop();
+        ASSERT_TRUE(task.has_value());
+        (*task)();
+    }
+    ASSERT_GE(std::chrono::steady_clock::now() - start, SHORT);
+    ASSERT_EQ(delayed.load(), 1);
+    ASSERT_GE(ticks.load(), 3);
+
+    ASSERT_TRUE(pq->CancelTimer(periodic));
+    ASSERT_FALSE(pq->CancelTimer(periodic));
+    ASSERT_THROW(pq->ScheduleEvery(std::chrono::nanoseconds::zero(), TaskPriority::High, [] {}), std::invalid_argument);
+    ASSERT_THROW(pq->ScheduleAfter(SHORT, PriorityLevel(5), [] {}), std::invalid_argument);
+
+    // Отмененная периодическая задача больше не попадает в очередь.
+    std::this_thread::sleep_for(SHORT);
+    pq->Shutdown();
+    const int after = ticks.load();
+    while(auto task = pq->Pop()) {
+        (*task)();
+    }
+    ASSERT_EQ(ticks.load(), after);
+}
+
+TEST_F(MyPriorityQueueTest, TimerForFullLevelRetriedOnNextTick) {
+    const std::map<TaskPriority, QueueOptions> config = {{TaskPriority::High, QueueOptions {true, 1}},
+                                                         {TaskPriority::Normal, QueueOptions {false, std::nullopt}}};
+    PriorityQueue pq(config);
+    std::string order;
+    ASSERT_EQ(pq.Push(TaskPriority::High, [&] { order += "F"; }), PushResult::Pushed);
+    pq.ScheduleAfter(std::chrono::milliseconds(1), TaskPriority::High, [&] { order += "T"; });
+
+    // Срок прошел, но уровень полон: таймер не теряется и не забирает место, а откладывается на следующий тик.
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_FALSE(pq.TryPop(TaskPriority::Normal).has_value());
+    ASSERT_EQ(pq.Size(), 1);
+
+    (*pq.Pop())();  // Освобождаем место; Pop() спит до тика повтора и переносит задачу таймера.
+    (*pq.Pop())();
+    ASSERT_EQ(order, "FT");
+}
+
+TEST(SpinWaitTest, BudgetAdaptsToOutcome) {
+    SpinWait spin({.spins = 1024, .yields = 2});
+    ASSERT_TRUE(spin.Enabled());
+    ASSERT_FALSE(SpinWait {}.Enabled());
+
+    // Вращение не дождалось задачи - бюджет сокращается, но не ниже kMinSpins.
+    for(int i = 0; i < 20; ++i) {
+        ASSERT_FALSE(spin.Wait([] { return false; }));
+    }
+    ASSERT_EQ(spin.Budget(), SpinWait::kMinSpins);
+
+    // Дождалось во время вращения - бюджет растет до заданного максимума.
+    for(int i = 0; i < 20; ++i) {
+        int checks = 0;
+        ASSERT_TRUE(spin.Wait([&] { return ++checks > 3; }));
+    }
+    ASSERT_EQ(spin.Budget(), 1024);
+}
+
+TEST_F(MyPriorityQueueTest, SpinningPopPicksUpTaskWithoutSleeping) {
+    SpinWait spin({.spins = 1u << 30});
+    std::jthread producer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        pq->Push(TaskPriority::Normal, [] {});
+    });
+    ASSERT_TRUE(pq->Pop(spin).has_value());
+
+    // Shutdown() во время вращения: уведомление приходит, когда потребитель еще не спит, и не должно потеряться.
+    for(int i = 0; i < 100; ++i) {
+        PriorityQueue queue(config);
+        std::jthread consumer([&queue] {
+            SpinWait short_spin({.spins = 64, .yields = 64});
+            while(queue.Pop(short_spin)) {
+            }
+        });
+        std::this_thread::yield();
+        queue.Shutdown();
+    }
+}
+
+TEST(PriorityQueueSizeTest, CountsTasksOnAllLevels) {
+    const std::map<TaskPriority, QueueOptions> config = {
+        {TaskPriority::High, QueueOptions {true, 4}},
+        {TaskPriority::Normal, QueueOptions {.bounded = true, .capacity = 4, .lock_free = true}},
+        {PriorityLevel(2), QueueOptions {false, std::nullopt}}};
+    PriorityQueue pq(config);
+    ASSERT_EQ(pq.Size(), 0);
+
+    for(auto priority: {TaskPriority::High, TaskPriority::Normal, PriorityLevel(2), PriorityLevel(2)}) {
+        pq.Push(priority, [] {});
+    }
+    ASSERT_EQ(pq.Size(), 4);
+    ASSERT_EQ(pq.GetQueues().at(PriorityLevel(2))->Size(), 2);
+
+    pq.Pop();
+    pq.TryPop(TaskPriority::Normal);
+    ASSERT_EQ(pq.Size(), 2);
+}
+
+TEST(PriorityQueuePermitsTest, EveryPathKeepsPermitsInStepWithTasks) {
+    // Задачи забирают и потребители PopBatch(), и TryPop() уровня, и производитель DropOldest. Если хоть один путь
+    // разойдется со счетчиком разрешений, потребитель либо уснет над задачей, либо будет вечно искать несуществующую.
+    const std::map<TaskPriority, QueueOptions> config = {
+        {TaskPriority::High, QueueOptions {.bounded = true, .capacity = 8, .overflow = OverflowPolicy::DropOldest}},
+        {TaskPriority::Normal, QueueOptions {false, std::nullopt}}};
+    PriorityQueue pq(config);
+
+    constexpr int kTasks = 20000;
+    std::atomic<int> executed {0};
+    std::atomic<bool> producing {true};
+    {
+        std::vector<std::jthread> threads;
+        for(int i = 0; i < 2; ++i) {
+            threads.emplace_back([&] {
+                std::array<Task, 4> batch;
+                while(const size_t size = pq.PopBatch(batch).size) {
+                    for(size_t n = 0; n < size; ++n) {
+                        batch[n]();
+                    }
+                }
+            });
+        }
+        threads.emplace_back([&] {
+            while(producing.load() || pq.Size() > 0) {
+                for(auto priority: {TaskPriority::High, TaskPriority::Normal}) {
+                    if(auto task = pq.TryPop(priority)) {
+                        (*task)();
+                    }
+                }
+            }
+        });
+        {
+            std::vector<std::jthread> producers;
+            for(int i = 0; i < 2; ++i) {
+                producers.emplace_back([&] {
+                    for(int n = 0; n < kTasks / 2; ++n) {
+                        const auto priority = n % 2 == 0 ? TaskPriority::High : TaskPriority::Normal;
+                        pq.Push(priority, [&executed] { executed.fetch_add(1); });
+                    }
+                });
+            }
+        }
+        producing = false;
+        threads.back().join();
+        pq.Shutdown();
+    }
+    const auto stats = pq.GetOverflowStats(TaskPriority::High);
+    ASSERT_EQ(executed.load() + static_cast<int>(stats.dropped_oldest), kTasks);
+    ASSERT_EQ(pq.Size(), 0);
+}
@@ -0,0 +1,129 @@
+#include "queue/sharded_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "queue/bounded_queue.hpp"
+#include "queue/priority_queue.hpp"
+#include "queue/unbounded_queue.hpp"
+#include "types.hpp"
+
+using namespace dispatcher;
+using namespace dispatcher::queue;
+
+namespace {
+
+template<typename Queue, typename... Args>
+std::unique_ptr<ShardedQueue> MakeSharded(size_t shards, Args... args) {
+    std::vector<std::unique_ptr<IQueue>> queues;
+    for(size_t i = 0; i < shards; ++i) {
+        queues.push_back(std::make_unique<Queue>(args...));
+    }
+    return std::make_unique<ShardedQueue>(std::move(queues));
+}
+
+}  // namespace
+
+TEST(ShardedQueueTest, EveryTaskIsPoppedExactlyOnce) {
+    auto queue = MakeSharded<UnboundedQueue>(8);
+    ASSERT_EQ(queue->ShardCount(), 8);
+    ASSERT_THROW(ShardedQueue({}), std::invalid_argument);
+
+    constexpr int kThreads = 4;
+    constexpr int kTasks   = 5000;
+    std::vector<std::atomic<int>> runs(kThreads * kTasks);
+    {
+        std::vector<std::jthread> threads;
+        for(int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&, t] {
+                for(int i = 0; i < kTasks; ++i) {
+                    queue->Push([&runs, index = t * kTasks + i] { runs[index]++; });
+                }
+            });
+        }
+    }
+    ASSERT_EQ(queue->Size(), kThreads * kTasks);
+    {
+        std::vector<std::jthread> threads;
+        for(int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&] {
+                while(auto task = queue->TryPop()) {
+                    (*task)();
+                }
+            });
+        }
+    }
+    for(const auto& count: runs) {
+        ASSERT_EQ(count.load(), 1);
+    }
+    ASSERT_FALSE(queue->TryPop().has_value());
+}
+
+TEST(ShardedQueueTest, EmptyAnswerAndCapacityCoverAllShards) {
+    auto queue = MakeSharded<BoundedQueue>(4, 2);
+    for(int i = 0; i < 8; ++i) {
+        Task task = [] {};
+        ASSERT_TRUE(queue->TryPush(task));
+    }
+    Task extra = [] {};
+    ASSERT_FALSE(queue->TryPush(extra));
+    ASSERT_TRUE(extra);
+    ASSERT_EQ(queue->PushDropOldest(std::move(extra)), 1);
+
+    // Последнюю задачу находит любой потребитель, в каком бы шарде она ни лежала.
+    std::vector<Task> out(3);
+    size_t popped = 0;
+    while(size_t size = queue->TryPopBatch(out)) {
+        popped += size;
+    }
+    ASSERT_EQ(popped, 8);
+    ASSERT_EQ(queue->Size(), 0);
+}
+
+TEST(ShardedPriorityQueueTest, KeepsStrictPriorityBetweenLevels) {
+    const std::map<TaskPriority, QueueOptions> config = {
+        {TaskPriority::High, QueueOptions {.bounded = true, .capacity = 1000, .shards = 4}},
+        {TaskPriority::Normal, QueueOptions {.bounded = false, .capacity = std::nullopt, .shards = 4}}};
+    PriorityQueue pq(config);
+    ASSERT_THROW(PriorityQueue({{TaskPriority::High, QueueOptions {.bounded = false, .shards = 0}}}),
+                 std::invalid_argument);
+
+    std::vector<TaskPriority> order;
+    for(int i = 0; i < 100; ++i) {
+        pq.Push(TaskPriority::Normal, [&order] { order.push_back(TaskPriority::Normal); });
+        pq.Push(TaskPriority::High, [&order] { order.push_back(TaskPriority::High); });
+    }
+    ASSERT_EQ(pq.Size(), 200);
+    for(int i = 0; i < 200; ++i) {
+        (*pq.Pop())();
+    }
+    for(int i = 0; i < 200; ++i) {
+        ASSERT_EQ(order[i], i < 100 ? TaskPriority::High : TaskPriority::Normal);
+    }
+
+    // Таймеры отключают быстрый путь, и сработавшая задача доходит до потребителя.
+    std::promise<void> fired;
+    pq.ScheduleAfter(std::chrono::milliseconds(5), TaskPriority::Normal, [&fired] { fired.set_value(); });
+    (*pq.Pop())();
+    ASSERT_EQ(fired.get_future().wait_for(std::chrono::seconds(0)), std::future_status::ready);
+
+    std::jthread consumer([&pq] {
+        while(auto task = pq.Pop()) {
+            (*task)();
+        }
+    });
+    std::atomic<int> counter = 0;
+    for(int i = 0; i < 1000; ++i) {
+        pq.Push(i % 2 ? TaskPriority::High : TaskPriority::Normal, [&counter] { counter++; });
+    }
+    while(counter.load() < 1000) {
+        std::this_thread::yield();
+    }
+    pq.Shutdown();
+}
@@ -0,0 +1,91 @@
+#include "queue/task_storage.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace dispatcher;
+using namespace dispatcher::queue;
+
+TEST(TaskRingTest, WrapsAroundInFifoOrder) {
+    TaskRing ring(3);
+    ASSERT_TRUE(ring.Empty());
+
+    std::vector<int> order;
+    int next = 0;
+    for(int round = 0; round < 5; ++round) {
+        while(!ring.Full()) {
+            ring.Push([&order, value = next++] { order.push_back(value); });
+        }
+        ring.Pop()();
+        ring.Pop()();
+    }
+    while(!ring.Empty()) {
+        ring.Pop()();
+    }
+
+    ASSERT_EQ(order.size(), static_cast<size_t>(next));
+    for(int i = 0; i < next; ++i) {
+        ASSERT_EQ(order[i], i);
+    }
+    ASSERT_THROW(TaskRing {0}, std::invalid_argument);
+}
+
+TEST(TaskRingTest, PoppedSlotReleasesCapture) {
+    TaskRing ring(2);
+    auto resource = std::make_shared<int>(0);
+    ring.Push([resource] {});
+    ring.Pop();
+    ASSERT_EQ(resource.use_count(), 1);
+}
+
+TEST(TaskSegmentListTest, GrowsAcrossSegmentsInFifoOrder) {
+    TaskSegmentList list;
+    constexpr int kTasks = TaskSegmentList::kSegmentSize * 5 + 7;
+    std::vector<int> order;
+    for(int i = 0; i < kTasks; ++i) {
+        list.Push([&order, i] { order.push_back(i); });
+    }
+    ASSERT_EQ(list.Size(), kTasks);
+    ASSERT_EQ(list.Segments(), 6);
+
+    while(!list.Empty()) {
+        list.Pop()();
+    }
+    ASSERT_EQ(order.size(), kTasks);
+    for(int i = 0; i < kTasks; ++i) {
+        ASSERT_EQ(order[i], i);
+    }
+}
+
+TEST(TaskSegmentListTest, SteadyStateReusesSegments) {
+    TaskSegmentList list;
+    // Очередь держит около трех сегментов задач и прокручивается много раз: новые сегменты берутся из списка
+    // свободных, а не из кучи.
+    constexpr size_t kDepth = TaskSegmentList::kSegmentSize * 3;
+    for(size_t i = 0; i < kDepth; ++i) {
+        list.Push([] {});
+    }
+    const size_t segments = list.Segments();
+    for(size_t i = 0; i < kDepth * 100; ++i) {
+        list.Push([] {});
+        list.Pop();
+    }
+    ASSERT_LE(list.Segments(), segments + 1);
+    ASSERT_EQ(list.Size(), kDepth);
+}
+
+TEST(TaskSegmentListTest, FreeListIsCapped) {
+    TaskSegmentList list;
+    constexpr size_t kSegments = TaskSegmentList::kMaxFreeSegments * 2;
+    for(size_t i = 0; i < kSegments * TaskSegmentList::kSegmentSize; ++i) {
+        list.Push([] {});
+    }
+    ASSERT_EQ(list.Segments(), kSegments);
+    while(!list.Empty()) {
+        list.Pop();
+    }
+    // Остаются головной сегмент и не больше kMaxFreeSegments свободных.
+    ASSERT_LE(list.Segments(), TaskSegmentList::kMaxFreeSegments + 1);
+}
@@ -0,0 +1,125 @@
+#include "queue/timer_wheel.hpp"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace dispatcher;
+using namespace dispatcher::queue;
+
+using namespace std::chrono_literals;
+
+struct TimerWheelTest: public testing::Test {
+    const TimerWheel::Clock::time_point origin {};
+    TimerWheel wheel {1ms, origin};
+    std::vector<TimerWheel::Expired> out;
+
+    // Выполняет сработавшие задачи.
+    void Run() {
+        for(auto& expired: out) {
+            expired.task();
+        }
+        out.clear();
+    }
+};
+
+TEST_F(TimerWheelTest, ExpiresInDeadlineOrder) {
+    std::string order;
+    wheel.Add(origin + 30ms, TaskPriority::Normal, [&] { order += "c"; });
+    wheel.Add(origin + 10ms, TaskPriority::High, [&] { order += "a"; });
+    wheel.Add(origin + 20ms, TaskPriority::Normal, [&] { order += "b"; });
+    ASSERT_EQ(wheel.Size(), 3);
+    ASSERT_EQ(wheel.NextExpiry(), origin + 10ms);
+
+    wheel.Expire(origin + 9ms, out);
+    ASSERT_TRUE(out.empty());
+
+    wheel.Expire(origin + 10ms, out);
+    ASSERT_EQ(out.size(), 1);
+    ASSERT_EQ(out[0].priority, TaskPriority::High);
+    Run();
+
+    wheel.Expire(origin + 100ms, out);
+    Run();
+    ASSERT_EQ(order, "abc");
+    ASSERT_TRUE(wheel.Empty());
+    ASSERT_FALSE(wheel.NextExpiry().has_value());
+}
+
+TEST_F(TimerWheelTest, DeadlineIsRoundedUpToTick) {
+    wheel.Add(origin + 1500us, TaskPriority::Normal, [] {});
+    wheel.Expire(origin + 1ms, out);
+    ASSERT_TRUE(out.empty());
+    wheel.Expire(origin + 2ms, out);
+    ASSERT_EQ(out.size(), 1);
+}
+
+TEST_F(TimerWheelTest, FarDeadlinesCascadeToLowerLevels) {
+    // Сроки на каждом уровне колеса и за его пределами.
+    const std::vector<std::chrono::milliseconds> deadlines = {5ms, 70ms, 4'500ms, 300'000ms, 20'000'000ms};
+    std::vector<std::chrono::milliseconds> fired;
+    for(auto deadline: deadlines) {
+        wheel.Add(origin + deadline, TaskPriority::Normal, [&fired, deadline] { fired.push_back(deadline); });
+    }
+
+    for(auto deadline: deadlines) {
+        // Колесо не срабатывает раньше срока, даже если его поворачивают по всем промежуточным моментам.
+        auto next = wheel.NextExpiry();
+        while(next && *next < origin + deadline) {
+            wheel.Expire(*next, out);
+            ASSERT_TRUE(out.empty());
+            next = wheel.NextExpiry();
+        }
+        ASSERT_EQ(next, origin + deadline);
+        wheel.Expire(origin + deadline, out);
+        Run();
+        ASSERT_EQ(fired.back(), deadline);
+    }
+    ASSERT_EQ(fired, deadlines);
+    ASSERT_TRUE(wheel.Empty());
+}
+
+TEST_F(TimerWheelTest, CancelIsIdempotentAndSafeAfterReuse) {
+    int fired          = 0;
+    const TimerId id   = wheel.Add(origin + 10ms, TaskPriority::Normal, [&] { fired++; });
+    const TimerId kept = wheel.Add(origin + 10ms, TaskPriority::Normal, [&] { fired += 10; });
+    ASSERT_TRUE(wheel.Cancel(id));
+    ASSERT_FALSE(wheel.Cancel(id));
+    ASSERT_EQ(wheel.Size(), 1);
+
+    // Узел отмененного таймера переиспользуется, но старый идентификатор его не отменит.
+    wheel.Add(origin + 20ms, TaskPriority::Normal, [&] { fired += 100; });
+    ASSERT_FALSE(wheel.Cancel(id));
+
+    wheel.Expire(origin + 20ms, out);
+    Run();
+    ASSERT_EQ(fired, 110);
+    ASSERT_FALSE(wheel.Cancel(kept));
+    ASSERT_FALSE(wheel.Cancel(0));
+}
+
+TEST_F(TimerWheelTest, PastDeadlineFiresOnNextTick) {
+    wheel.Expire(origin + 50ms, out);
+    wheel.Add(origin + 10ms, TaskPriority::Normal, [] {});
+    ASSERT_EQ(wheel.NextExpiry(), origin + 51ms);
+    wheel.Expire(origin + 51ms, out);
+    ASSERT_EQ(out.size(), 1);
+}
+
+TEST_F(TimerWheelTest, ManyTimers) {
+    constexpr int kTimers = 10'000;
+    std::vector<TimerId> ids;
+    int fired = 0;
+    for(int i = 0; i < kTimers; ++i) {
+        const auto deadline = origin + std::chrono::milliseconds(i * 7 % 5'000);
+        ids.push_back(wheel.Add(deadline, TaskPriority::Normal, [&] { fired++; }));
+    }
+    for(int i = 0; i < kTimers; i += 2) {
+        ASSERT_TRUE(wheel.Cancel(ids[i]));
+    }
+    wheel.Expire(origin + 5'000ms, out);
+    Run();
+    ASSERT_EQ(fired, kTimers / 2);
+    ASSERT_TRUE(wheel.Empty());
+}
@@ -107,3 +107,42 @@ TEST(UnboundedQueueTest, MultiProducerMultiConsumerStress) {
 
     ASSERT_EQ(counter.load(), 2 * N);
 }
+
+TEST(UnboundedQueueTest, PushBatchWakesAllConsumers) {
+    UnboundedQueue q;
+    std::atomic<int> counter = 0;
+
+    auto consumer = [&] {
+        auto task = q.Pop();
+        ASSERT_TRUE(task.has_value());
+        (*task)();
+    };
+
+    {
+        std::jthread c1(consumer);
+        std::jthread c2(consumer);
+        std::jthread c3(consumer);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+        std::vector<Task> batch;
+        for(int i = 0; i < 3; ++i) {
+            batch.emplace_back([&] { counter++; });
+        }
+        q.PushBatch(batch);
+    }
+
+    ASSERT_EQ(counter.load(), 3);
+}
+
+TEST(UnboundedQueueTest, TryPopBatchTakesUpToSpanSize) {
+    UnboundedQueue q;
+    std::vector<Task> out(4);
+    ASSERT_EQ(q.TryPopBatch(out), 0);
+
+    for(int i = 0; i < 6; ++i) {
+        q.Push([] {});
+    }
+    ASSERT_EQ(q.TryPopBatch(out), 4);
+    ASSERT_EQ(q.TryPopBatch(out), 2);
+    ASSERT_FALSE(q.TryPop().has_value());
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "strand.hpp"
+#include "task_dispatcher.hpp"
+
+using dispatcher::Strand;
+using dispatcher::TaskDispatcher;
+using dispatcher::TaskPriority;
+
+TEST(StrandTest, RunsTasksOfOneStrandInOrderAndOneAtATime) {
+    TaskDispatcher td(4);
+    constexpr int kStrands = 8;
+    constexpr int kTasks   = 2000;
+
+    std::vector<Strand> strands;
+    std::vector<std::vector<int>> seen(kStrands);
+    std::vector<std::atomic<int>> running(kStrands);
+    std::atomic<bool> overlapped {false};
+    for(int i = 0; i < kStrands; ++i) {
+        strands.push_back(td.MakeStrand(TaskPriority::Normal));
+    }
+
+    // Несколько производителей на каждый Strand: порядок задается последовательностью Schedule() одного потока, поэтому
+    // задачи пишут номер производителя и свой номер, а проверяется порядок внутри каждого производителя.
+    {
+        std::vector<std::jthread> producers;
+        for(int producer = 0; producer < 2; ++producer) {
+            producers.emplace_back([&, producer] {
+                for(int n = 0; n < kTasks; ++n) {
+                    const int key = n % kStrands;
+                    strands[key].Schedule([&, key, producer, n] {
+                        if(running[key].fetch_add(1) != 0) {
+                            overlapped = true;
+                        }
+                        seen[key].push_back(producer * kTasks + n);  // Без мьютекса: задачи Strand не пересекаются.
+                        running[key].fetch_sub(1);
+                    });
+                }
+            });
+        }
+    }
+    strands[0].Submit([] {}).Get();  // Для каждого Strand дожидаемся последней задачи.
+    for(int key = 1; key < kStrands; ++key) {
+        strands[key].Submit([] {}).Get();
+    }
+
+    ASSERT_FALSE(overlapped.load());
+    for(int key = 0; key < kStrands; ++key) {
+        ASSERT_EQ(seen[key].size(), 2 * kTasks / kStrands);
+        std::vector<int> last(2, -1);
+        for(int value: seen[key]) {
+            const int producer = value / kTasks;
+            ASSERT_LT(last[producer], value);
+            last[producer] = value;
+        }
+    }
+}
+
+TEST(StrandTest, DifferentStrandsRunInParallel) {
+    TaskDispatcher td(2);
+    auto first  = td.MakeStrand(TaskPriority::Normal);
+    auto second = td.MakeStrand(TaskPriority::Normal);
+
+    // Каждая задача ждет, пока стартует задача другого Strand: если бы Strand выполнялись по очереди, ни одна бы не
+    // дождалась.
+    std::atomic<int> started {0};
+    auto rendezvous = [&started] {
+        started.fetch_add(1);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while(started.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        return started.load() == 2;
+    };
+    auto a = first.Submit(rendezvous);
+    auto b = second.Submit(rendezvous);
+    ASSERT_TRUE(a.Get());
+    ASSERT_TRUE(b.Get());
+}
+
+TEST(StrandTest, ExceptionDoesNotStopStrand) {
+    TaskDispatcher td(2);
+    auto strand = td.MakeStrand(TaskPriority::High);
+    strand.Schedule([] { throw std::runtime_error("strand task failed"); });
+    auto failed = strand.Submit([]() -> int { throw std::runtime_error("reported"); });
+    auto value  = strand.Submit([] { return 42; });
+
+    ASSERT_THROW(failed.Get(), std::runtime_error);
+    ASSERT_EQ(value.Get(), 42);
+    ASSERT_FALSE(td.HasPriority(dispatcher::PriorityLevel(5)));
+    ASSERT_THROW(td.MakeStrand(dispatcher::PriorityLevel(5)), std::invalid_argument);
+}
+
+TEST(StrandTest, DropOldestLevelRejected) {
+    const std::map<TaskPriority, dispatcher::queue::QueueOptions> config = {
+        {TaskPriority::High,
+         {.bounded = true, .capacity = 4, .overflow = dispatcher::queue::OverflowPolicy::DropOldest}},
+        {TaskPriority::Normal, {false, std::nullopt}}};
+    TaskDispatcher td(1, config);
+    ASSERT_THROW(td.MakeStrand(TaskPriority::High), std::invalid_argument);
+    ASSERT_TRUE(td.MakeStrand(TaskPriority::Normal).Valid());
+}
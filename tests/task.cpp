@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <future>
+#include <memory>
+
+#include "task.hpp"
+
+using dispatcher::BasicTask;
+using dispatcher::Task;
+
+TEST(TaskTest, DefaultConstructedIsEmpty) {
+    Task task;
+    ASSERT_FALSE(static_cast<bool>(task));
+
+    Task null_task = nullptr;
+    ASSERT_FALSE(static_cast<bool>(null_task));
+}
+
+TEST(TaskTest, InvokesInlineCallable) {
+    int value = 0;
+    Task task = [&value] { value = 42; };
+
+    ASSERT_TRUE(static_cast<bool>(task));
+    task();
+    ASSERT_EQ(value, 42);
+}
+
+TEST(TaskTest, TypicalLambdasFitInline) {
+    int a = 0, b = 0, c = 0;
+    auto small = [&a, &b, &c, x = 1, y = 2.0] { a = x + static_cast<int>(y) + b + c; };
+    static_assert(Task::IsInline<decltype(small)>());
+
+    auto large = [buffer = std::array<char, 256> {}] { (void) buffer; };
+    static_assert(!Task::IsInline<decltype(large)>());
+}
+
+TEST(TaskTest, MoveOnlyCaptures) {
+    auto ptr  = std::make_unique<int>(7);
+    int value = 0;
+
+    Task task = [p = std::move(ptr), &value] { value = *p; };
+    Task moved(std::move(task));
+
+    ASSERT_FALSE(static_cast<bool>(task));
+    moved();
+    ASSERT_EQ(value, 7);
+}
+
+TEST(TaskTest, HoldsPackagedTask) {
+    std::packaged_task<int()> pt([] { return 5; });
+    auto fut = pt.get_future();
+
+    Task task = std::move(pt);
+    task();
+
+    ASSERT_EQ(fut.get(), 5);
+}
+
+TEST(TaskTest, HeapCallableSurvivesMoves) {
+    std::array<int, 64> data {};
+    data[63] = 11;
+    int value = 0;
+
+    Task task = [data, &value] { value = data[63]; };
+    Task other;
+    other = std::move(task);
+    Task third(std::move(other));
+
+    third();
+    ASSERT_EQ(value, 11);
+}
+
+TEST(TaskTest, DestroysCapturedState) {
+    auto shared = std::make_shared<int>(1);
+    {
+        Task inline_task = [shared] {};
+        BasicTask<8> heap_task = [shared, pad = std::array<char, 32> {}] {};
+        ASSERT_EQ(shared.use_count(), 3);
+
+        inline_task = nullptr;
+        ASSERT_EQ(shared.use_count(), 2);
+    }
+    ASSERT_EQ(shared.use_count(), 1);
+}
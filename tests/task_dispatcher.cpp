@@ -11,6 +11,7 @@
 #include "queue/priority_queue.hpp"
 #include "types.hpp"
 
+using dispatcher::Task;
 using dispatcher::TaskDispatcher;
 using dispatcher::TaskPriority;
 using dispatcher::queue::QueueOptions;
@@ -110,3 +111,152 @@ TEST(TaskDispatcherTest, NoTaskLossOnConcurrentShutdown) {
 
     ASSERT_EQ(counter.load(), 100);
 }
+
+TEST(TaskDispatcherTest, WorkStealingNestedSchedule) {
+    std::atomic<int> counter = 0;
+
+    std::function<void(int)> spawn;
+
+    {
+        TaskDispatcher td(4, config, {.work_stealing = true});
+
+        // Каждая задача порождает подзадачи изнутри воркера - они попадают в локальные очереди воркеров.
+        spawn = [&](int depth) {
+            counter++;
+            if(depth == 0) {
+                return;
+            }
+            for(int i = 0; i < 3; ++i) {
+                td.Schedule(i == 0 ? TaskPriority::High : TaskPriority::Normal, [&, depth] { spawn(depth - 1); });
+            }
+        };
+
+        td.Schedule(TaskPriority::Normal, [&] { spawn(6); });
+    }
+
+    ASSERT_EQ(counter.load(), (729 * 3 - 1) / 2);  // 1 + 3 + 9 + ... + 3^6.
+}
+
+TEST(TaskDispatcherTest, ScheduleBulk) {
+    std::atomic<int> counter = 0;
+
+    {
+        TaskDispatcher td(4, config);
+
+        std::vector<Task> batch;
+        for(int i = 0; i < 300; ++i) {  // Больше емкости High-очереди (100): пачка дозаливается по мере освобождения.
+            batch.emplace_back([&] { counter++; });
+        }
+        td.ScheduleBulk(TaskPriority::High, batch);
+
+        // Произвольный диапазон вызываемых объектов.
+        auto lambdas = std::views::iota(0, 50) | std::views::transform([&](int) { return [&] { counter++; }; });
+        td.ScheduleBulk(TaskPriority::Normal, lambdas);
+    }
+
+    ASSERT_EQ(counter.load(), 350);
+}
+
+TEST(TaskDispatcherTest, SubmitReturnsResultsAndExceptions) {
+    TaskDispatcher td(4, config);
+
+    auto answer = td.Submit(TaskPriority::High, [] { return 42; });
+    auto failed = td.Submit(TaskPriority::Normal, []() -> int { throw std::runtime_error("boom"); });
+    auto moved  = td.Submit(TaskPriority::Normal, [p = std::make_unique<int>(5)] { return *p * 2; });
+
+    ASSERT_EQ(answer.Get(), 42);
+    ASSERT_THROW(failed.Get(), std::runtime_error);
+    ASSERT_EQ(moved.Get(), 10);
+}
+
+TEST(TaskDispatcherTest, MetricsSnapshot) {
+    {
+        TaskDispatcher td(2, config);
+        ASSERT_FALSE(td.GetMetrics().has_value());
+    }
+
+    std::optional<dispatcher::metrics::Snapshot> snapshot;
+    {
+        TaskDispatcher td(2, config, {}, true);
+        for(int i = 0; i < 20; ++i) {
+            td.Schedule(TaskPriority::High, [] { std::this_thread::sleep_for(std::chrono::microseconds(100)); });
+            td.Schedule(TaskPriority::Normal, [] {});
+        }
+        td.Submit(TaskPriority::Normal, [] { return 1; }).Get();
+        snapshot = td.GetMetrics();
+    }
+
+    ASSERT_TRUE(snapshot.has_value());
+    ASSERT_EQ(snapshot->levels.size(), 2);
+    ASSERT_EQ(snapshot->levels[0].enqueued, 20);
+    ASSERT_EQ(snapshot->levels[1].enqueued, 21);
+    ASSERT_GE(snapshot->levels[0].completed + snapshot->levels[0].depth, 1);
+    ASSERT_LE(snapshot->workers.size(), 2);
+}
+
+TEST(TaskDispatcherTest, TryScheduleAndScheduleForWhenFull) {
+    const std::map<TaskPriority, QueueOptions> small = {{TaskPriority::High, QueueOptions {true, 1}}};
+    TaskDispatcher td(1, small);
+
+    std::promise<void> release;
+    auto gate = release.get_future().share();
+    std::atomic<int> started = 0;
+    td.Schedule(TaskPriority::High, [gate, &started] {
+        started++;
+        gate.wait();  // Занимаем единственного воркера.
+    });
+    while(started.load() == 0) {
+        std::this_thread::yield();
+    }
+
+    ASSERT_TRUE(td.TrySchedule(TaskPriority::High, [] {}));
+    ASSERT_FALSE(td.TrySchedule(TaskPriority::High, [] {}));
+    ASSERT_FALSE(td.ScheduleFor(TaskPriority::High, [] {}, std::chrono::milliseconds(20)));
+
+    const auto stats = td.GetOverflowStats(TaskPriority::High);
+    ASSERT_EQ(stats.rejected, 1);
+    ASSERT_EQ(stats.timed_out, 1);
+
+    release.set_value();
+}
+
+TEST(TaskDispatcherTest, ScheduleAfterAndEvery) {
+    TaskDispatcher td(2, config);
+
+    std::promise<std::chrono::steady_clock::time_point> fired;
+    auto when        = fired.get_future();
+    const auto start = std::chrono::steady_clock::now();
+    td.ScheduleAfter(SHORT, TaskPriority::Normal, [&fired] { fired.set_value(std::chrono::steady_clock::now()); });
+    const auto cancelled = td.ScheduleAfter(SHORT, TaskPriority::Normal, [] { FAIL() << "cancelled timer fired"; });
+    ASSERT_TRUE(td.CancelTimer(cancelled));
+
+    std::atomic<int> ticks = 0;
+    const auto periodic    = td.ScheduleEvery(std::chrono::milliseconds(5), TaskPriority::High, [&ticks] { ticks++; });
+
+    ASSERT_EQ(when.wait_for(LONG * 5), std::future_status::ready);
+    ASSERT_GE(when.get() - start, SHORT);
+    while(ticks.load() < 3) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(td.CancelTimer(periodic));
+    ASSERT_FALSE(td.CancelTimer(periodic));
+}
+
+TEST(TaskDispatcherTest, ShardedLevelsExecuteAllTasks) {
+    const std::map<TaskPriority, QueueOptions> sharded = {
+        {TaskPriority::High, QueueOptions {.bounded = true, .capacity = 100, .shards = 4}},
+        {TaskPriority::Normal, QueueOptions {.bounded = false, .capacity = std::nullopt, .shards = 4}}};
+    std::atomic<int> counter = 0;
+    {
+        TaskDispatcher td(4, sharded, {.pop_batch = 8});
+        std::vector<std::jthread> producers;
+        for(int p = 0; p < 4; ++p) {
+            producers.emplace_back([&] {
+                for(int i = 0; i < 1000; ++i) {
+                    td.Schedule(i % 2 ? TaskPriority::High : TaskPriority::Normal, [&counter] { counter++; });
+                }
+            });
+        }
+    }
+    ASSERT_EQ(counter.load(), 4000);
+}
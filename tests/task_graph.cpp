@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "task_dispatcher.hpp"
+#include "task_graph.hpp"
+
+using dispatcher::ExecutableGraph;
+using dispatcher::TaskDispatcher;
+using dispatcher::TaskGraph;
+using dispatcher::TaskPriority;
+
+TEST(TaskGraphTest, RunsDiamondInDependencyOrderRepeatedly) {
+    TaskDispatcher td(4);
+    std::mutex mutex;
+    std::vector<char> order;
+    auto record = [&](char name) {
+        return [&, name] {
+            std::lock_guard lock(mutex);
+            order.push_back(name);
+        };
+    };
+
+    TaskGraph builder;
+    const auto a = builder.AddNode(TaskPriority::Normal, record('a'));
+    const auto b = builder.AddNode(TaskPriority::High, record('b'));
+    const auto c = builder.AddNode(TaskPriority::Normal, record('c'));
+    const auto d = builder.AddNode(TaskPriority::High, record('d'));
+    builder.AddEdge(a, b);
+    builder.AddEdge(a, c);
+    builder.AddEdge(b, d);
+    builder.AddEdge(c, d);
+    const auto graph = builder.Instantiate();
+    ASSERT_EQ(graph.Size(), 4);
+    ASSERT_EQ(builder.Size(), 0);
+
+    for(int run = 0; run < 50; ++run) {
+        order.clear();
+        graph.Run(td).Get();
+        ASSERT_EQ(order.size(), 4);
+        ASSERT_EQ(order.front(), 'a');
+        ASSERT_EQ(order.back(), 'd');
+    }
+}
+
+TEST(TaskGraphTest, OverlappingRunsOfWideGraph) {
+    TaskDispatcher td(4, dispatcher::init_config, {.work_stealing = true});
+    std::atomic<int> counter = 0;
+    std::atomic<int> sinks   = 0;
+
+    TaskGraph builder;
+    const auto source = builder.AddNode(TaskPriority::High, [] {});
+    const auto sink   = builder.AddNode(TaskPriority::High, [&] { sinks++; });
+    for(int i = 0; i < 200; ++i) {
+        const auto node = builder.AddNode(TaskPriority::Normal, [&] { counter++; });
+        builder.AddEdge(source, node);
+        builder.AddEdge(node, sink);
+    }
+    const auto graph = builder.Instantiate();
+
+    std::vector<dispatcher::Future<void>> runs;
+    for(int run = 0; run < 10; ++run) {
+        runs.push_back(graph.Run(td));
+    }
+    for(auto& run: runs) {
+        run.Get();
+    }
+    ASSERT_EQ(counter.load(), 2000);
+    ASSERT_EQ(sinks.load(), 10);
+}
+
+TEST(TaskGraphTest, FailureSkipsDescendantsAndReachesFuture) {
+    TaskDispatcher td(2);
+    std::atomic<bool> descendant = false;
+
+    TaskGraph builder;
+    const auto failing = builder.AddNode(TaskPriority::Normal, [] { throw std::runtime_error("boom"); });
+    const auto after   = builder.AddNode(TaskPriority::Normal, [&] { descendant = true; });
+    builder.AddEdge(failing, after);
+    const auto graph = builder.Instantiate();
+
+    ASSERT_THROW(graph.Run(td).Get(), std::runtime_error);
+    ASSERT_FALSE(descendant.load());
+    ASSERT_THROW(graph.Run(td).Get(), std::runtime_error);  // Граф переиспользуется и после ошибки.
+
+    ExecutableGraph empty = TaskGraph().Instantiate();
+    ASSERT_TRUE(empty.Run(td).IsReady());
+}
+
+TEST(TaskGraphTest, RejectsInvalidGraphs) {
+    TaskGraph builder;
+    const auto a = builder.AddNode(TaskPriority::Normal, [] {});
+    const auto b = builder.AddNode(TaskPriority::Normal, [] {});
+    ASSERT_THROW(builder.AddNode(TaskPriority::Normal, nullptr), std::invalid_argument);
+    ASSERT_THROW(builder.AddEdge(a, 7), std::invalid_argument);
+
+    builder.AddEdge(a, b);
+    builder.AddEdge(b, a);
+    ASSERT_THROW(builder.Instantiate(), std::invalid_argument);
+}
+
+TEST(TaskGraphTest, RejectsUnconfiguredPriorityBeforeRunningNodes) {
+    std::atomic<bool> started = false;
+    TaskGraph builder;
+    const auto a = builder.AddNode(TaskPriority::Normal, [&] { started = true; });
+    const auto c = builder.AddNode(dispatcher::PriorityLevel(5), [] {});
+    builder.AddEdge(a, c);
+    ExecutableGraph graph = builder.Instantiate();
+
+    {
+        TaskDispatcher td(2);
+        ASSERT_THROW(graph.Run(td), std::invalid_argument);
+    }
+    ASSERT_FALSE(started.load());  // Пул уже остановлен: узел a так и не был поставлен.
+}
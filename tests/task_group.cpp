@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+#include "task_dispatcher.hpp"
+#include "task_group.hpp"
+
+using dispatcher::TaskDispatcher;
+using dispatcher::TaskGroup;
+using dispatcher::TaskPriority;
+
+namespace {
+
+// Рекурсивный fork-join: каждая задача ждет две подзадачи, поэтому ожидающих задач больше, чем воркеров.
+uint64_t Fibonacci(TaskDispatcher& td, int n) {
+    if(n < 2) {
+        return static_cast<uint64_t>(n);
+    }
+    uint64_t left  = 0;
+    uint64_t right = 0;
+    TaskGroup group(td);
+    group.Run(TaskPriority::Normal, [&] { left = Fibonacci(td, n - 1); });
+    group.Run(TaskPriority::Normal, [&] { right = Fibonacci(td, n - 2); });
+    group.Wait();
+    return left + right;
+}
+
+}  // namespace
+
+TEST(TaskGroupTest, SingleWorkerRunsSubtasksWhileWaiting) {
+    // С обычным ожиданием единственный воркер ждал бы подзадачи, которые некому выполнить.
+    TaskDispatcher td(1);
+    auto result = td.Submit(TaskPriority::Normal, [&td] {
+        std::atomic<int> sum {0};
+        TaskGroup group(td);
+        for(int i = 1; i <= 10; ++i) {
+            group.Run(i % 2 == 0 ? TaskPriority::High : TaskPriority::Normal, [&sum, i] { sum.fetch_add(i); });
+        }
+        group.Wait();
+        return sum.load();
+    });
+    ASSERT_EQ(result.Get(), 55);
+}
+
+TEST(TaskGroupTest, RecursiveForkJoinOnSmallPools) {
+    TaskDispatcher shared(2);
+    ASSERT_EQ(shared.Submit(TaskPriority::Normal, [&shared] { return Fibonacci(shared, 16); }).Get(), 987);
+
+    TaskDispatcher stealing(2, dispatcher::init_config, {.work_stealing = true});
+    ASSERT_EQ(stealing.Submit(TaskPriority::Normal, [&stealing] { return Fibonacci(stealing, 16); }).Get(), 987);
+}
+
+TEST(TaskGroupTest, WaitRethrowsFirstExceptionAndGroupIsReusable) {
+    TaskDispatcher td(2);
+    TaskGroup group(td);
+    std::atomic<int> done {0};
+    group.Run(TaskPriority::Normal, [] { throw std::runtime_error("subtask failed"); });
+    group.Run(TaskPriority::Normal, [&done] { done.fetch_add(1); });
+    ASSERT_THROW(group.Wait(), std::runtime_error);  // Ожидание из потока вне пула.
+    ASSERT_EQ(done.load(), 1);
+
+    group.Run(TaskPriority::High, [&done] { done.fetch_add(1); });
+    group.Wait();
+    ASSERT_EQ(done.load(), 2);
+}
+
+TEST(TaskGroupTest, UnknownLevelIsRejectedWithoutBlockingWait) {
+    TaskDispatcher td(2);
+    TaskGroup group(td);
+    ASSERT_THROW(group.Run(dispatcher::PriorityLevel(5), [] {}), std::invalid_argument);
+    group.Wait();  // Отклоненная задача в группе не числится.
+
+    auto result = td.Submit(TaskPriority::Normal, [&td] {
+        TaskGroup inner(td);
+        EXPECT_THROW(inner.Run(dispatcher::PriorityLevel(5), [] {}), std::invalid_argument);
+        inner.Wait();
+        return true;
+    });
+    ASSERT_TRUE(result.Get());
+}
+
+TEST(TaskGroupTest, WorkerWaitWakesWhenGroupFinishesElsewhere) {
+    // Подзадачу забирает второй воркер, а ожидающий засыпает в очереди: проснуться он должен по завершению группы.
+    TaskDispatcher td(2);
+    auto result = td.Submit(TaskPriority::Normal, [&td] {
+        std::atomic<bool> done {false};
+        TaskGroup group(td);
+        group.Run(TaskPriority::Normal, [&done] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            done = true;
+        });
+        group.Wait();
+        return done.load();
+    });
+    ASSERT_TRUE(result.Get());
+}
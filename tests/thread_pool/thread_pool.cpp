@@ -5,6 +5,8 @@
 #include <future>
 #include <thread>
 #include <vector>
+#include <set>
+#include <mutex>
 
 #include "thread_pool/thread_pool.hpp"
 #include "queue/priority_queue.hpp"
@@ -165,3 +167,219 @@ TEST_F(MyThreadPoolTest, NonStdExceptionInsideTaskHandled) {
 
     EXPECT_EQ(ok.load(), 1);
 }
+
+TEST_F(MyThreadPoolTest, WorkStealingExecutesAllTasks) {
+    std::atomic<int> counter = 0;
+
+    {
+        ThreadPool pool(pq, 4, {.work_stealing = true});
+        for(int i = 0; i < 100; ++i) {
+            pq->Push(TaskPriority::Normal, [&] { counter.fetch_add(1); });
+        }
+    }
+
+    ASSERT_EQ(counter.load(), 100);
+}
+
+TEST_F(MyThreadPoolTest, WorkStealingLocalTasksDrainedAndStolen) {
+    std::atomic<int> counter = 0;
+    std::mutex mutex;
+    std::set<std::thread::id> executors;
+
+    {
+        ThreadPool pool(pq, 4, {.work_stealing = true});
+        pq->Push(TaskPriority::Normal, [&] {
+            //        .     .
+            for(int i = 0; i < 200; ++i) {
+                dispatcher::Task task = [&] {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    {
+                        std::lock_guard lock(mutex);
+                        executors.insert(std::this_thread::get_id());
+                    }
+                    counter++;
+                };
+                if(!pool.TryPushLocal(TaskPriority::Normal, task)) {
+                    pq->Push(TaskPriority::Normal, std::move(task));
+                }
+            }
+        });
+    }
+
+    ASSERT_EQ(counter.load(), 200);
+    ASSERT_GT(executors.size(), 1);
+}
+
+TEST_F(MyThreadPoolTest, WorkStealingRespectsPriorities) {
+    std::vector<std::string> order;
+
+    pq->Push(TaskPriority::Normal, [&] { order.emplace_back("N1"); });
+    pq->Push(TaskPriority::Normal, [&] { order.emplace_back("N2"); });
+    pq->Push(TaskPriority::High, [&] { order.emplace_back("H1"); });
+    pq->Push(TaskPriority::High, [&] { order.emplace_back("H2"); });
+
+    {
+        ThreadPool pool(pq, 1, {.work_stealing = true});
+    }
+
+    ASSERT_EQ(order, (std::vector<std::string> {"H1", "H2", "N1", "N2"}));
+}
+
+// ,        ,        .
+struct LocalLoad {
+    ThreadPool* pool;
+    std::shared_ptr<PriorityQueue> pq;
+    const std::atomic<bool>* fired;
+    std::chrono::steady_clock::time_point deadline;
+
+    void operator()() const {
+        if(fired->load() || std::chrono::steady_clock::now() >= deadline) {
+            return;
+        }
+        dispatcher::Task task = *this;
+        if(!pool->TryPushLocal(TaskPriority::Normal, task)) {
+            pq->Push(TaskPriority::Normal, std::move(task));
+        }
+    }
+};
+
+TEST_F(MyThreadPoolTest, WorkStealingFiresTimersUnderLoad) {
+    std::atomic<bool> fired = false;
+    std::chrono::steady_clock::duration delay {};
+
+    {
+        ThreadPool pool(pq, 1, {.work_stealing = true});
+        const auto start = std::chrono::steady_clock::now();
+        //            Pop()  .
+        pq->Push(TaskPriority::Normal, LocalLoad {&pool, pq, &fired, start + std::chrono::seconds(5)});
+        pq->ScheduleAfter(std::chrono::milliseconds(10), TaskPriority::High, [&] {
+            delay = std::chrono::steady_clock::now() - start;
+            fired = true;
+        });
+        while(!fired.load() && std::chrono::steady_clock::now() < start + std::chrono::seconds(5)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));  //  Shutdown()   .
+        }
+    }
+
+    ASSERT_TRUE(fired.load());
+    ASSERT_LT(delay, std::chrono::seconds(1));
+}
+
+TEST_F(MyThreadPoolTest, TryPushLocalRejectedOutsideWorker) {
+    ThreadPool pool(pq, 2, {.work_stealing = true});
+
+    dispatcher::Task task = [] {};
+    ASSERT_FALSE(pool.TryPushLocal(TaskPriority::Normal, task));
+    ASSERT_TRUE(static_cast<bool>(task));
+}
+
+TEST_F(MyThreadPoolTest, PopBatchExecutesAllTasks) {
+    std::atomic<int> counter = 0;
+
+    {
+        ThreadPool pool(pq, 4, {.pop_batch = 8});
+        for(int i = 0; i < 100; ++i) {
+            pq->Push(TaskPriority::Normal, [&] { counter.fetch_add(1); });
+        }
+    }
+
+    ASSERT_EQ(counter.load(), 100);
+}
+
+TEST_F(MyThreadPoolTest, PopBatchRechecksHighBetweenTasks) {
+    std::vector<std::string> order;
+
+    // Первая задача пачки Normal кладет задачу High - она должна выполниться раньше остальных задач пачки.
+    pq->Push(TaskPriority::Normal, [&] {
+        order.emplace_back("N1");
+        pq->Push(TaskPriority::High, [&] { order.emplace_back("H1"); });
+    });
+    pq->Push(TaskPriority::Normal, [&] { order.emplace_back("N2"); });
+    pq->Push(TaskPriority::Normal, [&] { order.emplace_back("N3"); });
+
+    {
+        ThreadPool pool(pq, 1, {.pop_batch = 4});
+    }
+
+    ASSERT_EQ(order, (std::vector<std::string> {"N1", "H1", "N2", "N3"}));
+}
+
+TEST_F(MyThreadPoolTest, SpinningWorkersExecuteAllTasks) {
+    // Пачки задач с паузами между ними: воркеры то дожидаются задач вращением, то засыпают.
+    using dispatcher::thread_pool::ThreadPoolOptions;
+    const std::vector<ThreadPoolOptions> variants = {
+        {.spin = {256, 4}}, {.pop_batch = 4, .spin = {256, 4}}, {.work_stealing = true, .spin = {256, 4}}};
+    for(const auto& options: variants) {
+        std::atomic<int> counter = 0;
+        {
+            ThreadPool pool(pq, 3, options);
+            for(int burst = 0; burst < 5; ++burst) {
+                for(int i = 0; i < 50; ++i) {
+                    pq->Push(i % 2 ? TaskPriority::High : TaskPriority::Normal, [&] { counter.fetch_add(1); });
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+        ASSERT_EQ(counter.load(), 250);
+        pq = std::make_shared<PriorityQueue>(config);
+    }
+}
+
+TEST_F(MyThreadPoolTest, ElasticPoolGrowsUnderBacklogAndRetiresIdleWorkers) {
+    using namespace std::chrono_literals;
+    const dispatcher::thread_pool::ThreadPoolOptions options = {
+        .max_threads = 4, .spawn_delay = 1ms, .idle_timeout = 20ms, .scale_interval = 1ms};
+    ThreadPool pool(pq, 1, options);
+    ASSERT_EQ(pool.ThreadCount(), 1);
+
+    auto wait_for_count = [&pool](size_t expected) {
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while(pool.ThreadCount() != expected && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(1ms);
+        }
+        return pool.ThreadCount();
+    };
+
+    // Задачи держат воркеров, пока не откроется шлюз: очередь не убывает, и пул растет до max_threads.
+    std::promise<void> release;
+    auto gate                = release.get_future().share();
+    std::atomic<int> counter = 0;
+    for(int i = 0; i < 8; ++i) {
+        pq->Push(TaskPriority::Normal, [gate, &counter] {
+            gate.wait();
+            counter++;
+        });
+    }
+    ASSERT_EQ(wait_for_count(4), 4);
+
+    release.set_value();
+    ASSERT_EQ(wait_for_count(1), 1);
+    ASSERT_EQ(counter.load(), 8);
+
+    // Ужавшийся пул по-прежнему выполняет задачи.
+    std::promise<void> done;
+    pq->Push(TaskPriority::High, [&done] { done.set_value(); });
+    ASSERT_EQ(done.get_future().wait_for(5s), std::future_status::ready);
+
+    const dispatcher::thread_pool::ThreadPoolOptions stealing = {.work_stealing = true, .max_threads = 4};
+    ASSERT_THROW(ThreadPool(pq, 1, stealing), std::invalid_argument);
+}
+
+TEST_F(MyThreadPoolTest, PinnedWorkersExecuteAllTasks) {
+    using dispatcher::thread_pool::Placement;
+    for(auto placement: {Placement::Cpu, Placement::Node}) {
+        for(bool work_stealing: {false, true}) {
+            const dispatcher::thread_pool::ThreadPoolOptions options = {.work_stealing = work_stealing,
+                                                                        .placement     = placement};
+            std::atomic<int> counter = 0;
+            {
+                ThreadPool pool(pq, 4, options);
+                for(int i = 0; i < 100; ++i) {
+                    pq->Push(TaskPriority::Normal, [&counter] { counter++; });
+                }
+            }
+            ASSERT_EQ(counter.load(), 100);
+            SetUp();
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "thread_pool/topology.hpp"
+
+using dispatcher::thread_pool::CpuTopology;
+using dispatcher::thread_pool::PinCurrentThread;
+
+TEST(CpuTopologyTest, ParsesKernelCpuList) {
+    ASSERT_EQ(CpuTopology::ParseCpuList("0"), std::vector<int>({0}));
+    ASSERT_EQ(CpuTopology::ParseCpuList("0-3,8,10-11\n"), std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+    ASSERT_EQ(CpuTopology::ParseCpuList("4,1-2,2"), std::vector<int>({1, 2, 4}));
+    ASSERT_TRUE(CpuTopology::ParseCpuList("\n").empty());
+
+    ASSERT_THROW(CpuTopology::ParseCpuList("3-1"), std::invalid_argument);
+    ASSERT_THROW(CpuTopology::ParseCpuList("a"), std::invalid_argument);
+    ASSERT_THROW(CpuTopology::ParseCpuList("1,,2"), std::invalid_argument);
+    ASSERT_THROW(CpuTopology::ParseCpuList("-1"), std::invalid_argument);
+}
+
+TEST(CpuTopologyTest, DiscoversDisjointNonEmptyNodes) {
+    const auto topology = CpuTopology::Discover();
+    ASSERT_FALSE(topology.nodes.empty());
+
+    std::set<int> seen;
+    for(const auto& node: topology.nodes) {
+        ASSERT_FALSE(node.empty());
+        for(int cpu: node) {
+            ASSERT_TRUE(seen.insert(cpu).second);
+        }
+    }
+}
+
+#ifdef __linux__
+TEST(CpuTopologyTest, PinsCurrentThread) {
+    const auto topology = CpuTopology::Discover();
+    const int cpu       = topology.nodes.back().back();
+
+    cpu_set_t saved;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(saved), &saved), 0);
+    ASSERT_TRUE(PinCurrentThread(std::vector<int> {cpu}));
+    ASSERT_EQ(sched_getcpu(), cpu);
+    ASSERT_FALSE(PinCurrentThread(std::vector<int> {}));
+    sched_setaffinity(0, sizeof(saved), &saved);
+}
+#endif
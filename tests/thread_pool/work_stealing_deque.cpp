@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "thread_pool/work_stealing_deque.hpp"
+
+using dispatcher::thread_pool::WorkStealingDeque;
+
+TEST(WorkStealingDequeTest, OwnerPopsLifoThiefStealsFifo) {
+    WorkStealingDeque deque;
+    std::vector<int> order;
+
+    deque.PushBottom([&] { order.push_back(1); });
+    deque.PushBottom([&] { order.push_back(2); });
+    deque.PushBottom([&] { order.push_back(3); });
+
+    (*deque.PopBottom())();  // 3 - самая свежая задача владельца.
+    (*deque.Steal())();      // 1 - вор забирает самую старую.
+    (*deque.PopBottom())();  // 2
+
+    ASSERT_EQ(order, (std::vector<int> {3, 1, 2}));
+    ASSERT_TRUE(deque.Empty());
+    ASSERT_FALSE(deque.PopBottom().has_value());
+    ASSERT_FALSE(deque.Steal().has_value());
+}
+
+TEST(WorkStealingDequeTest, ConcurrentOwnerAndThieves) {
+    WorkStealingDeque deque;
+    static constexpr int N = 10000;
+
+    std::atomic<int> executed = 0;
+    std::atomic<bool> done    = false;
+
+    auto thief = [&] {
+        while(!done.load() || !deque.Empty()) {
+            if(auto task = deque.Steal()) {
+                (*task)();
+            }
+        }
+    };
+
+    {
+        std::jthread t1(thief);
+        std::jthread t2(thief);
+
+        for(int i = 0; i < N; ++i) {
+            deque.PushBottom([&] { executed++; });
+            if(i % 2 == 0) {
+                if(auto task = deque.PopBottom()) {
+                    (*task)();
+                }
+            }
+        }
+        done = true;
+    }
+
+    ASSERT_EQ(executed.load(), N);
+}